@@ -30,6 +30,10 @@
 #include "Image.h"
 #include "State.h"
 #include "Canvas.h"
+#include "AsyncWriter.h"
+#include "GzipWriter.h"
+#include "MappedWriter.h"
+#include <cstdio>
 
 #ifdef MAC_ENV
 #include <ApplicationServices/ApplicationServices.h>
@@ -41,12 +45,6 @@
 
 using namespace CanvasExport;
 
-namespace CanvasExport
-{
-	// Globals
-	bool debug;
-}
-
 /*
 */
 Plugin* AllocatePlugin(SPPluginRef pluginRef)
@@ -199,33 +197,109 @@ ASErr Ai2CanvasPlugin::WriteText(const char* pathName)
 
 	bool debug = (CGEventSourceFlagsState(kCGEventSourceStateHIDSystemState) & kCGEventFlagMaskShift);
 
+	// Determine if the option key is being held down (to indicate minified production code)
+	bool isMinifyKeyDown = (CGEventSourceFlagsState(kCGEventSourceStateHIDSystemState) & kCGEventFlagMaskAlternate);
+
+	// Determine if the command key is being held down (to indicate writing a source map)
+	bool isSourceMapKeyDown = (CGEventSourceFlagsState(kCGEventSourceStateHIDSystemState) & kCGEventFlagMaskCommand);
+
 	openFile = true;
 #endif 
 #ifdef WIN_ENV
 	// Determine if the left shift key is being held down (to indicate previewing HTML file after export)
 	bool isDebugKeyDown = ((GetKeyState(VK_LSHIFT) & 0x1000) != 0);
+
+	// Determine if the left control key is being held down (to indicate minified production code)
+	bool isMinifyKeyDown = ((GetKeyState(VK_LCONTROL) & 0x1000) != 0);
+
+	// Determine if the left alt key is being held down (to indicate writing a source map)
+	bool isSourceMapKeyDown = ((GetKeyState(VK_LMENU) & 0x1000) != 0);
 	openFile = true;
 #endif 
 
 	// Create file
+	// Code is written on a writer thread, so the export never waits on the disk (or network share) unless the writer falls behind
+	// Files on local volumes are written straight into a memory-mapped file instead (mapping a network file would make the export
+	// wait on page faults)
 	std::string file = std::string(pathName);
-	if (OpenFile(file))
+	MappedWriter mappedWriter;
+	AsyncWriter asyncWriter;
+	FileWriter* writer = NULL;
+	if (MappedWriter::IsLocalPath(file) && mappedWriter.Open(file))
+	{
+		writer = &mappedWriter;
+	}
+	else if (asyncWriter.Open(file))
+	{
+		writer = &asyncWriter;
+	}
+
+	// Keep a compressed copy beside it (for archiving and static serving)
+	// The compressor gets each block the file's writer publishes, so code is still formatted straight into the file's blocks
+	GzipWriter gzipWriter;
+	if (writer && gzipWriter.Open(file + ".gz"))
+	{
+		writer->SetCopy(&gzipWriter);
+	}
+	if (writer)
 	{
+		// Everything the export writes goes through its context
+		std::ostream sink(writer);
+		ExportContext context(sink);
+		context.writer = writer;
+
 		// Set debug mode
-		//CanvasExport::debug = (openFile != 0);
-		CanvasExport::debug = isDebugKeyDown;
+		//context.debug = (openFile != 0);
+		context.debug = isDebugKeyDown;
+
+		// Set production mode
+		context.SetMinify(isMinifyKeyDown);
+
+		// Map lines back to the art that produced them?
+		SourceMap sourceMap;
+		if (isSourceMapKeyDown)
+		{
+			context.SetSourceMap(&sourceMap);
+		}
+
+		// Attribute output size and draw cost to functions, layers and groups
+		// (production code skips it, since it would look up every group's name)
+		CostReport report;
+		if (!isMinifyKeyDown)
+		{
+			context.SetReport(&report);
+		}
 
 		// Create a new document
-		TypescriptDocument* document = new TypescriptDocument(file);
+		TypescriptDocument* document = new TypescriptDocument(file, context);
 
 		// Render the document
 		document->Render();
 
-		// Close the file
-		CloseFile();
-
 		// Delete document
 		delete document;
+
+		// Write the source map beside the file, and point browsers at it
+		if (context.sourceMap)
+		{
+			std::string fileName = ai::FilePath(ai::UnicodeString(file)).GetFileName().as_Platform();
+			context.WriteLine("//# sourceMappingURL=" + fileName + ".map");
+			sourceMap.Write(file + ".map", fileName);
+		}
+
+		// Finish writing the file (and then its compressed copy, which gets the file's last block when it closes)
+		bool isWritten = writer->Close();
+		bool isCompressed = gzipWriter.Close();
+		if (!isWritten || !isCompressed)
+		{
+			// Don't leave a truncated compressed copy behind
+			std::remove((file + ".gz").c_str());
+			error = kWriteFileErr;
+		}
+	}
+	else
+	{
+		error = kWriteFileErr;
 	}
 
 #ifdef MAC_ENV
@@ -235,7 +309,7 @@ ASErr Ai2CanvasPlugin::WriteText(const char* pathName)
 	std::string uri = aiFilePath.GetAsURL(false).as_Platform();
 
 	// Launch the file
-	if (openFile)
+	if (openFile && !error)
 	{
 		std::string command = "open " + uri;
 		system(command.c_str());
@@ -243,7 +317,7 @@ ASErr Ai2CanvasPlugin::WriteText(const char* pathName)
 #endif 
 #ifdef WIN_ENV
 	// Launch the file
-	if (openFile)
+	if (openFile && !error)
 	{
 		ShellExecute(NULL, "open", pathName, NULL, NULL, SW_SHOWNORMAL);
 	}
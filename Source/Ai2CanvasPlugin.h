@@ -32,6 +32,9 @@
 
 #define kMaxStringLength 256
 
+// Returned when the exported file couldn't be written
+#define kWriteFileErr 'WRIT'
+
 /**	Creates a new Ai2CanvasPlugin.
 	@param pluginRef IN unique reference to this plugin.
 	@return pointer to new Ai2CanvasPlugin.
@@ -64,6 +64,8 @@ extern "C"
 	AIEntrySuite *sAIEntry = NULL;
 	AIRealBezierSuite *sAIRealBezier = NULL;
 	AIArtboardSuite  *sAIArtboard = NULL;
+	AIUIDUtilsSuite *sAIUIDUtils = NULL;
+	AIUndoSuite *sAIUndo = NULL;
 };
 
 ImportSuite gImportSuites[] = 
@@ -106,6 +108,8 @@ ImportSuite gImportSuites[] =
 	kAIImageOptSuite, kAIImageOptSuiteVersion, &sAIImageOpt,
 	kAIRealBezierSuite, kAIRealBezierSuiteVersion, &sAIRealBezier,
 	kAIArtboardSuite, kAIArtboardVersion, &sAIArtboard,
+	kAIUIDUtilsSuite, kAIUIDUtilsSuiteVersion, &sAIUIDUtils,
+	kAIUndoSuite, kAIUndoSuiteVersion, &sAIUndo,
 
 	IMPORT_TEXT_SUITES
 	nil, 0, nil
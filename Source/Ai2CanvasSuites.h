@@ -38,6 +38,8 @@
 #include "AIPathStyle.h"
 #include "AIGradient.h"
 #include "AIArtboard.h"
+#include "AIUIDUtils.h"
+#include "AIUndo.h"
 
 extern	"C"	AIUnicodeStringSuite*	sAIUnicodeString;
 extern  "C" SPBlocksSuite*			sSPBlocks;
@@ -77,5 +79,7 @@ extern "C" AIBlendStyleSuite *sAIBlendStyle;
 extern "C" AILayerSuite *sAILayer;
 extern "C" AIRealBezierSuite *sAIRealBezier;
 extern "C" AIArtboardSuite  *sAIArtboard;
+extern "C" AIUIDUtilsSuite *sAIUIDUtils;
+extern "C" AIUndoSuite *sAIUndo;
 
 #endif // End Ai2CanvasSuites.h
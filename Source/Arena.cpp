@@ -0,0 +1,114 @@
+// Arena.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "Arena.h"
+
+using namespace CanvasExport;
+
+// Big enough for a typical document's layers, functions, canvases, images and patterns in a single block
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+Arena::Arena()
+{
+	// Initialize Arena
+	this->current = NULL;
+	this->remaining = 0;
+	this->blockSize = ARENA_BLOCK_SIZE;
+	this->objectCount = 0;
+	this->blockCount = 0;
+	this->bytesUsed = 0;
+}
+
+Arena::~Arena()
+{
+	// Destroy everything
+	Release();
+}
+
+// Returns aligned memory from the current block (or a new one if it doesn't fit)
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+	// Padding to reach the requested alignment
+	size_t padding = (alignment - ((size_t)current % alignment)) % alignment;
+
+	// Does it fit in the current block?
+	if (current == NULL || (size + padding) > remaining)
+	{
+		// Oversized requests get a block of their own
+		size_t newBlockSize = (size + alignment > blockSize) ? (size + alignment) : blockSize;
+
+		// Allocate a new block
+		char* block = (char*)malloc(newBlockSize);
+		if (block == NULL)
+		{
+			throw std::bad_alloc();
+		}
+		blocks.push_back(block);
+		blockCount++;
+
+		// Start using it
+		current = block;
+		remaining = newBlockSize;
+		padding = (alignment - ((size_t)current % alignment)) % alignment;
+	}
+
+	// Hand out the memory
+	void* result = current + padding;
+	current += (padding + size);
+	remaining -= (padding + size);
+	bytesUsed += size;
+
+	return result;
+}
+
+// Destroys all objects and frees all blocks
+void Arena::Release()
+{
+	// Destroy objects in reverse order of creation
+	for (size_t i = destructors.size(); i > 0; i--)
+	{
+		destructors[i - 1].destroy(destructors[i - 1].object);
+	}
+	destructors.clear();
+
+	// Free blocks
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		free(blocks[i]);
+	}
+	blocks.clear();
+
+	// Reset
+	this->current = NULL;
+	this->remaining = 0;
+	this->objectCount = 0;
+	this->blockCount = 0;
+	this->bytesUsed = 0;
+}
+
+// Report arena usage
+void Arena::DebugInfo(std::ostream& out)
+{
+	// Arena statistics
+	out << "//   Arena objects = " << objectCount << ", heap allocations = " << blockCount << ", bytes used = " << bytesUsed << endl;
+}
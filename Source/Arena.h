@@ -0,0 +1,108 @@
+// Arena.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace CanvasExport
+{
+	/// Hands out memory for the objects of one export from a few large blocks, and releases them all at once
+	class Arena
+	{
+	private:
+
+		/// Destroys an object created in the arena
+		struct Destructor
+		{
+			void*				object;				// Object to destroy
+			void				(*destroy)(void*);	// Calls the object's destructor
+		};
+
+		std::vector<char*>		blocks;				// Allocated blocks
+		std::vector<Destructor>	destructors;		// Objects to destroy (in creation order)
+		char*					current;			// Next free byte in the current block
+		size_t					remaining;			// Free bytes left in the current block
+
+		template<typename T>
+		static void				Destroy(void* object) { static_cast<T*>(object)->~T(); }
+
+	public:
+
+		Arena();
+		~Arena();
+
+		size_t					blockSize;			// Size of each block (larger requests get their own block)
+		unsigned int			objectCount;		// Objects created since the arena was last released
+		unsigned int			blockCount;			// Heap allocations made for those objects
+		size_t					bytesUsed;			// Bytes handed out
+
+		void*					Allocate(size_t size, size_t alignment);
+		void					Release();
+		void					DebugInfo(std::ostream& out);
+
+		/// Constructs a T in the arena (its destructor runs when the arena is released)
+		template<typename T, typename... Args>
+		T*						Create(Args&&... args)
+		{
+			// Construct in place
+			T* object = new (Allocate(sizeof(T), std::alignment_of<T>::value)) T(std::forward<Args>(args)...);
+
+			// Remember to destroy it (if there's anything to do)
+			if (!std::is_trivially_destructible<T>::value)
+			{
+				Destructor destructor = { object, &Destroy<T> };
+				destructors.push_back(destructor);
+			}
+
+			// Count it
+			objectCount++;
+
+			return object;
+		}
+
+	};
+
+	/// A stack of values that keeps its storage between uses (for recursive traversals)
+	template<typename T>
+	class ScratchStack
+	{
+	private:
+
+		std::vector<T>			items;				// Items (storage is kept when popped)
+
+	public:
+
+		size_t					Size() const { return items.size(); }
+		void					Push(const T& item) { items.push_back(item); }
+		T&						operator[](size_t index) { return items[index]; }
+		void					PopTo(size_t size) { items.resize(size); }
+
+	};
+}
+
+#endif
@@ -0,0 +1,212 @@
+// ArtInfoCache.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "ArtInfoCache.h"
+
+using namespace CanvasExport;
+
+ArtInfoCache::ArtInfoCache()
+{
+	// Initialize ArtInfoCache
+	this->lookups = 0;
+	this->queries = 0;
+}
+
+ArtInfoCache::~ArtInfoCache()
+{
+}
+
+// Returns the properties of an art object, after querying the requested property (if it hasn't been yet)
+ArtInfo& ArtInfoCache::Fetch(AIArtHandle artHandle, unsigned int property)
+{
+	// Find (or add) the art
+	std::unordered_map<AIArtHandle, ArtInfo>::iterator it = infos.find(artHandle);
+	if (it == infos.end())
+	{
+		ArtInfo info;
+		info.fetched = 0;
+		it = infos.insert(std::make_pair(artHandle, info)).first;
+	}
+	ArtInfo& info = it->second;
+
+	// Count the request
+	lookups++;
+
+	// Do we need to ask Illustrator?
+	if ((info.fetched & property) == 0)
+	{
+		// Query the property (counting the SDK calls)
+		switch (property)
+		{
+		case kType:
+		{
+			info.type = 0;
+			sAIArt->GetArtType(artHandle, &info.type);
+			queries++;
+			break;
+		}
+		case kUserAttrs:
+		{
+			info.userAttrs = 0;
+			sAIArt->GetArtUserAttr(artHandle, kArtHidden | kArtPartOfCompound, &info.userAttrs);
+			queries++;
+			break;
+		}
+		case kBounds:
+		{
+			sAIArt->GetArtBounds(artHandle, &info.bounds);
+			queries++;
+			break;
+		}
+		case kStyle:
+		{
+			sAIPathStyle->GetPathStyle(artHandle, &info.style);
+			queries++;
+			break;
+		}
+		case kOpacity:
+		{
+			info.opacity = sAIBlendStyle->GetOpacity(artHandle);
+			queries++;
+			break;
+		}
+		case kBlendingMode:
+		{
+			info.blendingMode = sAIBlendStyle->GetBlendingMode(artHandle);
+			queries++;
+			break;
+		}
+		case kClipping:
+		{
+			// Plug-in art knows whether it clips, other art has it in its style
+			if (GetType(artHandle) == kPluginArt)
+			{
+				info.clipping = false;
+				sAIPluginGroup->GetPluginArtClipping(artHandle, &info.clipping);
+				queries++;
+			}
+			else
+			{
+				info.clipping = GetStyle(artHandle).clip;
+			}
+			break;
+		}
+		case kName:
+		{
+			AIBoolean isDefaultName = false;
+			sAIArt->GetArtName(artHandle, info.name, &isDefaultName);
+			queries++;
+			break;
+		}
+		case kUTF8Name:
+		{
+			// Conversion only (no query)
+			info.utf8Name = GetName(artHandle).as_UTF8();
+			break;
+		}
+		case kUID:
+		{
+			// Only art that already has a UID (assigning one would change the document)
+			ai::UnicodeString uidName;
+			AIErr result = sAIUIDUtils->GetArtUIDName(artHandle, uidName);
+			if (result == kNoErr)
+			{
+				info.uid = uidName.as_UTF8();
+			}
+			queries++;
+			break;
+		}
+		}
+
+		// Remember that we have it
+		info.fetched |= property;
+	}
+
+	return info;
+}
+
+short ArtInfoCache::GetType(AIArtHandle artHandle)
+{
+	return Fetch(artHandle, kType).type;
+}
+
+bool ArtInfoCache::IsHidden(AIArtHandle artHandle)
+{
+	return ((Fetch(artHandle, kUserAttrs).userAttrs & kArtHidden) == kArtHidden);
+}
+
+bool ArtInfoCache::IsPartOfCompound(AIArtHandle artHandle)
+{
+	return ((Fetch(artHandle, kUserAttrs).userAttrs & kArtPartOfCompound) == kArtPartOfCompound);
+}
+
+const AIRealRect& ArtInfoCache::GetBounds(AIArtHandle artHandle)
+{
+	return Fetch(artHandle, kBounds).bounds;
+}
+
+const AIPathStyle& ArtInfoCache::GetStyle(AIArtHandle artHandle)
+{
+	return Fetch(artHandle, kStyle).style;
+}
+
+AIReal ArtInfoCache::GetOpacity(AIArtHandle artHandle)
+{
+	return Fetch(artHandle, kOpacity).opacity;
+}
+
+AIBlendingMode ArtInfoCache::GetBlendingMode(AIArtHandle artHandle)
+{
+	return Fetch(artHandle, kBlendingMode).blendingMode;
+}
+
+bool ArtInfoCache::IsClipping(AIArtHandle artHandle)
+{
+	return (Fetch(artHandle, kClipping).clipping != 0);
+}
+
+const ai::UnicodeString& ArtInfoCache::GetName(AIArtHandle artHandle)
+{
+	return Fetch(artHandle, kName).name;
+}
+
+const std::string& ArtInfoCache::GetUTF8Name(AIArtHandle artHandle)
+{
+	return Fetch(artHandle, kUTF8Name).utf8Name;
+}
+
+const std::string& ArtInfoCache::GetUID(AIArtHandle artHandle)
+{
+	return Fetch(artHandle, kUID).uid;
+}
+
+// Report cache statistics
+void ArtInfoCache::DebugInfo(std::ostream& out)
+{
+	out << "//   Art properties: " << infos.size() << " art objects, " << lookups << " lookups (SDK calls without the cache), " << queries << " SDK calls";
+	if (!infos.empty())
+	{
+		out << " (" << setiosflags(ios::fixed) << setprecision(1) << ((AIReal)queries / infos.size()) << " per art object)";
+	}
+	out << endl;
+}
@@ -0,0 +1,96 @@
+// ArtInfoCache.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ARTINFOCACHE_H
+#define ARTINFOCACHE_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include <unordered_map>
+
+namespace CanvasExport
+{
+	/// Properties of an art object (each one is queried from Illustrator the first time it's needed)
+	struct ArtInfo
+	{
+		unsigned int		fetched;				// Properties queried so far (ArtInfoCache::kType, ...)
+		short				type;					// Art type
+		ai::int32			userAttrs;				// Hidden and part-of-compound attributes
+		AIRealRect			bounds;					// Bounds (including transformations)
+		AIPathStyle			style;					// Path style
+		AIReal				opacity;				// Opacity
+		AIBlendingMode		blendingMode;			// Blending mode
+		AIBoolean			clipping;				// Is this a clipping path (or clipping plug-in art)?
+		ai::UnicodeString	name;					// Art name
+		std::string			utf8Name;				// Art name as UTF-8 (converted when first needed)
+		std::string			uid;					// Unique ID as UTF-8 (empty if the art doesn't have one)
+	};
+
+	/// Remembers art properties for the duration of an export, so scanning, traversal and rendering each
+	/// only ask Illustrator once
+	class ArtInfoCache
+	{
+	private:
+
+		std::unordered_map<AIArtHandle, ArtInfo>	infos;	// Properties (by art handle)
+
+		ArtInfo&			Fetch(AIArtHandle artHandle, unsigned int property);
+
+	public:
+
+		enum
+		{
+			kType = 1 << 0,
+			kUserAttrs = 1 << 1,
+			kBounds = 1 << 2,
+			kStyle = 1 << 3,
+			kOpacity = 1 << 4,
+			kBlendingMode = 1 << 5,
+			kClipping = 1 << 6,
+			kName = 1 << 7,
+			kUTF8Name = 1 << 8,
+			kUID = 1 << 9
+		};
+
+		ArtInfoCache();
+		~ArtInfoCache();
+
+		unsigned int		lookups;				// Properties asked for (each was an SDK call before this cache)
+		unsigned int		queries;				// SDK calls actually made
+
+		short				GetType(AIArtHandle artHandle);
+		bool				IsHidden(AIArtHandle artHandle);
+		bool				IsPartOfCompound(AIArtHandle artHandle);
+		const AIRealRect&	GetBounds(AIArtHandle artHandle);
+		const AIPathStyle&	GetStyle(AIArtHandle artHandle);
+		AIReal				GetOpacity(AIArtHandle artHandle);
+		AIBlendingMode		GetBlendingMode(AIArtHandle artHandle);
+		bool				IsClipping(AIArtHandle artHandle);
+		const ai::UnicodeString&	GetName(AIArtHandle artHandle);
+		const std::string&	GetUTF8Name(AIArtHandle artHandle);
+		const std::string&	GetUID(AIArtHandle artHandle);
+		void				DebugInfo(std::ostream& out);
+
+	};
+}
+
+#endif
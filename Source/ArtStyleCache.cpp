@@ -0,0 +1,67 @@
+// ArtStyleCache.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "ArtStyleCache.h"
+
+using namespace CanvasExport;
+
+ArtStyleCache::ArtStyleCache()
+{
+	// Initialize ArtStyleCache
+	this->hits = 0;
+	this->misses = 0;
+}
+
+ArtStyleCache::~ArtStyleCache()
+{
+}
+
+// Find a parsed style, returns NULL if it hasn't been parsed yet
+const ParsedArtStyle* ArtStyleCache::Find(AIArtStyleHandle artStyle)
+{
+	const ParsedArtStyle* result = NULL;
+
+	// Look up the style
+	std::unordered_map<AIArtStyleHandle, ParsedArtStyle>::const_iterator it = styles.find(artStyle);
+	if (it != styles.end())
+	{
+		// Found a match
+		result = &it->second;
+		hits++;
+	}
+
+	return result;
+}
+
+// Remember a parsed style
+const ParsedArtStyle& ArtStyleCache::Add(AIArtStyleHandle artStyle, const ParsedArtStyle& parsedStyle)
+{
+	misses++;
+	return styles[artStyle] = parsedStyle;
+}
+
+// Report cache statistics
+void ArtStyleCache::DebugInfo(std::ostream& out)
+{
+	out << "//   Art styles parsed = " << misses << ", cache hits = " << hits << endl;
+}
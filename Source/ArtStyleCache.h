@@ -0,0 +1,75 @@
+// ArtStyleCache.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ARTSTYLECACHE_H
+#define ARTSTYLECACHE_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include <unordered_map>
+
+namespace CanvasExport
+{
+	// Drop shadow parameters
+	// NOTE: Should this move to State? That's where it is in the canvas spec.
+	struct DropShadow
+	{
+		AIReal			horz;						// Horizontal offset
+		AIReal			vert;						// Vertical offset
+		AIReal			blur;						// Blur amount
+		AIFillStyle		shadowStyle;				// Fill style
+		AIReal			opac;						// Opacity
+	};
+
+	/// The parts of an art style that matter for rendering
+	/// (opacity and blending mode belong to the art, so they aren't part of this)
+	struct ParsedArtStyle
+	{
+		ASInt32						postEffectCount;	// Number of post-effects
+		AIBoolean					hasDropShadow;		// Is one of them a drop shadow?
+		DropShadow					dropShadow;			// Drop shadow parameters (if there is one)
+		std::vector<std::string>	effectNames;		// Live Effect names (for debugging)
+	};
+
+	/// Remembers parsed art styles, since many art objects share the same style
+	class ArtStyleCache
+	{
+	private:
+
+		std::unordered_map<AIArtStyleHandle, ParsedArtStyle>	styles;		// Parsed styles (by style handle)
+
+	public:
+
+		ArtStyleCache();
+		~ArtStyleCache();
+
+		unsigned int			hits;				// Styles answered by the cache
+		unsigned int			misses;				// Styles that had to be parsed
+
+		const ParsedArtStyle*	Find(AIArtStyleHandle artStyle);
+		const ParsedArtStyle&	Add(AIArtStyleHandle artStyle, const ParsedArtStyle& parsedStyle);
+		void					DebugInfo(std::ostream& out);
+
+	};
+}
+
+#endif
@@ -0,0 +1,187 @@
+// ArtTraversal.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "ArtTraversal.h"
+
+using namespace CanvasExport;
+
+ArtTraversal::ArtTraversal()
+{
+	// Initialize ArtTraversal
+	this->artInfo = NULL;
+	this->artCount = 0;
+	this->maxDepth = 0;
+}
+
+ArtTraversal::~ArtTraversal()
+{
+}
+
+// Visits art, its siblings and (as the visitor asks) their children
+// Runs may nest (e.g. from a visitor callback), since each run only uses the stacks above where it started
+void ArtTraversal::Run(ArtVisitor& visitor, AIArtHandle artHandle, unsigned int depth, unsigned int order)
+{
+	// Where this run starts on the stacks
+	size_t firstFrame = frames.Size();
+
+	// Root frame, holding the art and its siblings
+	Frame root = { NULL, depth, 0, 0, 0, 0, depth };
+	frames.Push(root);
+	frames[firstFrame].first = artHandles.Size();
+	GatherSiblings(artHandle, order);
+	frames[firstFrame].count = artHandles.Size() - frames[firstFrame].first;
+
+	// Until the root frame is done
+	while (frames.Size() > firstFrame)
+	{
+		size_t frameIndex = frames.Size() - 1;
+
+		// Any children left in the current list?
+		if (frames[frameIndex].position < frames[frameIndex].count)
+		{
+			// Next child
+			AIArtHandle childArtHandle = artHandles[frames[frameIndex].first + frames[frameIndex].position];
+			unsigned int childDepth = frames[frameIndex].childDepth;
+			frames[frameIndex].position++;
+			artCount++;
+
+			// Visit it (and enter it, if the visitor wants its children)
+			if (visitor.Enter(childArtHandle, childDepth))
+			{
+				Frame frame = { childArtHandle, childDepth, 0, artHandles.Size(), 0, 0, childDepth };
+				frames.Push(frame);
+
+				// Track nesting
+				if (frames.Size() - firstFrame > maxDepth)
+				{
+					maxDepth = (unsigned int)(frames.Size() - firstFrame);
+				}
+
+				// Get the first list of children (or leave right away)
+				if (!NextChildren(visitor, frames.Size() - 1, order))
+				{
+					visitor.Leave(childArtHandle, childDepth);
+					frames.PopTo(frames.Size() - 1);
+				}
+			}
+		}
+		else
+		{
+			// Done with this list
+			artHandles.PopTo(frames[frameIndex].first);
+
+			// Root frame, or no more children?
+			if (frames[frameIndex].artHandle == NULL || !NextChildren(visitor, frameIndex, order))
+			{
+				// Leave the art
+				if (frames[frameIndex].artHandle != NULL)
+				{
+					visitor.Leave(frames[frameIndex].artHandle, frames[frameIndex].depth);
+				}
+				frames.PopTo(frameIndex);
+			}
+		}
+	}
+}
+
+// Pushes art and its siblings onto the art handle stack, in traversal order
+void ArtTraversal::GatherSiblings(AIArtHandle artHandle, unsigned int order)
+{
+	size_t first = artHandles.Size();
+	bool hasClipIndex = false;
+	size_t clipIndex = 0;
+
+	// Gather art and its siblings
+	while (artHandle != NULL)
+	{
+		// Only painter order cares about clipping (plug-in art, e.g. Pathfinder, or a clipping path style)
+		if (order == kPainterOrder && artInfo->IsClipping(artHandle))
+		{
+			// Remember where the clipping path is
+			clipIndex = artHandles.Size();
+			hasClipIndex = true;
+		}
+
+		// Add this art handle
+		artHandles.Push(artHandle);
+
+		// Find the next sibling
+		sAIArt->GetArtSibling(artHandle, &artHandle);
+	}
+
+	// Painter order?
+	if (order == kPainterOrder && artHandles.Size() > first)
+	{
+		// Did we find a clipping path?
+		if (hasClipIndex)
+		{
+			// Remember the clip art handle
+			AIArtHandle clipArtHandle = artHandles[clipIndex];
+
+			// Shift everything from the clip "up" by 1
+			for (size_t i = clipIndex; i < (artHandles.Size() - 1); i++)
+			{
+				artHandles[i] = artHandles[i + 1];
+			}
+
+			// Move the clip art handle to the end
+			artHandles[(artHandles.Size() - 1)] = clipArtHandle;
+		}
+
+		// Reverse, because of canvas "painter model" (so the clip comes first)
+		for (size_t i = first, j = artHandles.Size() - 1; i < j; i++, j--)
+		{
+			AIArtHandle swap = artHandles[i];
+			artHandles[i] = artHandles[j];
+			artHandles[j] = swap;
+		}
+	}
+}
+
+// Asks the visitor for the frame's next list of children, returns false if there are no more
+bool ArtTraversal::NextChildren(ArtVisitor& visitor, size_t frameIndex, unsigned int order)
+{
+	// Ask for the next list
+	AIArtHandle firstChild = NULL;
+	unsigned int childDepth = frames[frameIndex].depth;
+	bool hasChildren = visitor.GetChildren(frames[frameIndex].artHandle, frames[frameIndex].depth, frames[frameIndex].pass, firstChild, childDepth);
+
+	// Did we get one? (an empty list just moves on to the next pass)
+	if (hasChildren)
+	{
+		frames[frameIndex].pass++;
+		frames[frameIndex].childDepth = childDepth;
+		frames[frameIndex].first = artHandles.Size();
+		frames[frameIndex].position = 0;
+		GatherSiblings(firstChild, order);
+		frames[frameIndex].count = artHandles.Size() - frames[frameIndex].first;
+	}
+
+	return hasChildren;
+}
+
+// Report traversal statistics
+void ArtTraversal::DebugInfo(std::ostream& out)
+{
+	out << "//   Art visited = " << artCount << ", deepest nesting = " << maxDepth << endl;
+}
@@ -0,0 +1,96 @@
+// ArtTraversal.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ARTTRAVERSAL_H
+#define ARTTRAVERSAL_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include "Arena.h"
+#include "ArtInfoCache.h"
+
+namespace CanvasExport
+{
+	/// Callbacks for an ArtTraversal
+	class ArtVisitor
+	{
+	public:
+
+		virtual ~ArtVisitor() {}
+
+		/// Called for each art object (with its siblings in traversal order)
+		/// Handles the art and returns false for leaves and skipped art, or returns true to visit children and Leave
+		/// (depth may be changed, and the new depth is passed to GetChildren and Leave)
+		virtual bool		Enter(AIArtHandle artHandle, unsigned int& depth) = 0;
+
+		/// Asks for the next list of children after pass earlier lists (pass starts at 0), returns false when there are no more
+		virtual bool		GetChildren(AIArtHandle artHandle, unsigned int depth, unsigned int pass, AIArtHandle& firstChild, unsigned int& childDepth) = 0;
+
+		/// Called after all of the art's children have been visited
+		virtual void		Leave(AIArtHandle artHandle, unsigned int depth) = 0;
+	};
+
+	/// Walks an art tree with an explicit stack (so deeply nested art can't overflow the call stack)
+	class ArtTraversal
+	{
+	private:
+
+		/// An entered art object and the list of children being visited
+		struct Frame
+		{
+			AIArtHandle			artHandle;			// Entered art (NULL for the root list)
+			unsigned int		depth;				// Depth of the entered art
+			unsigned int		pass;				// Number of child lists requested so far
+			size_t				first;				// Index of the first child in artHandles
+			size_t				count;				// Number of children
+			size_t				position;			// Next child to visit
+			unsigned int		childDepth;			// Depth of the children
+		};
+
+		ScratchStack<AIArtHandle>	artHandles;		// Child lists of all frames
+		ScratchStack<Frame>		frames;				// Entered art
+
+		void					GatherSiblings(AIArtHandle artHandle, unsigned int order);
+		bool					NextChildren(ArtVisitor& visitor, size_t frameIndex, unsigned int order);
+
+	public:
+
+		enum
+		{
+			kDocumentOrder = 0,						// Siblings in document order (top-most first)
+			kPainterOrder							// Clipping art first, then siblings bottom-most first
+		};
+
+		ArtTraversal();
+		~ArtTraversal();
+
+		ArtInfoCache*			artInfo;			// Art properties (for clipping)
+		unsigned int			artCount;			// Art objects visited
+		unsigned int			maxDepth;			// Deepest nesting reached
+
+		void					Run(ArtVisitor& visitor, AIArtHandle artHandle, unsigned int depth, unsigned int order);
+		void					DebugInfo(std::ostream& out);
+
+	};
+}
+
+#endif
@@ -0,0 +1,257 @@
+// AsyncWriter.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "AsyncWriter.h"
+#include <chrono>
+
+using namespace CanvasExport;
+
+AsyncWriter::AsyncWriter()
+{
+	// Initialize AsyncWriter
+	this->blocks = new Block[kBlockCount];
+	this->head = 0;
+	this->tail = 0;
+	this->isClosing = false;
+	this->isWriterWaiting = false;
+	this->isExportWaiting = false;
+	this->hasFailed = false;
+	this->isOpen = false;
+	this->openMode = ios::out;
+	this->stallSeconds = 0.0;
+	this->stallCount = 0;
+	this->blockCount = 0;
+	this->byteCount = 0;
+}
+
+AsyncWriter::~AsyncWriter()
+{
+	// Make sure the writer thread is done
+	Close();
+
+	delete[] blocks;
+}
+
+// Open the file, and start the writer thread
+bool AsyncWriter::Open(const std::string& path)
+{
+	// Open the file (text mode by default, like the rest of the export's files)
+	file.open(path.c_str(), openMode);
+	isOpen = file.is_open();
+	if (isOpen)
+	{
+		// Start filling the first block
+		head = 0;
+		tail = 0;
+		isClosing = false;
+		hasFailed = false;
+		setp(blocks[0].data, blocks[0].data + kBlockSize);
+
+		// Start writing
+		writer = std::thread(&AsyncWriter::Write, this);
+	}
+
+	return isOpen;
+}
+
+// Hand the remaining output to the writer thread, wait for it to finish and close the file
+// Returns false if anything couldn't be written
+bool AsyncWriter::Close()
+{
+	if (isOpen)
+	{
+		// Hand over the last (partial) block
+		if (pptr() > pbase())
+		{
+			Publish();
+		}
+		setp(NULL, NULL);
+
+		// Let the writer finish
+		isClosing.store(true);
+		Wake(isWriterWaiting, blockPublished);
+		writer.join();
+		file.close();
+		isOpen = false;
+	}
+
+	return !hasFailed;
+}
+
+// Hand the current block to the writer thread
+void AsyncWriter::Publish()
+{
+	size_t index = head.load(std::memory_order_relaxed);
+	Block& block = blocks[index % kBlockCount];
+	block.size = pptr() - pbase();
+
+	// Statistics
+	blockCount++;
+	byteCount += block.size;
+
+	// Pass it on to the copy before the writer may reuse it
+	CopyBlock(block.data, block.size);
+
+	// The writer may now read the block
+	head.store(index + 1);
+	Wake(isWriterWaiting, blockPublished);
+}
+
+// Wake a thread that's waiting on a condition
+// NOTE: Waiters set their flag before they check for the last time (all sequentially consistent), so either the waiter sees
+//       the change, or we see the flag. The mutex is held from the waiter's check until it sleeps, so the wakeup isn't missed
+void AsyncWriter::Wake(const std::atomic<bool>& isWaiting, std::condition_variable& condition)
+{
+	if (isWaiting.load())
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		condition.notify_one();
+	}
+}
+
+// Start filling the next block, waiting for the writer if every block is in use
+void AsyncWriter::Acquire()
+{
+	size_t index = head.load(std::memory_order_relaxed);
+
+	// Is the ring full?
+	if (index - tail.load(std::memory_order_acquire) >= kBlockCount)
+	{
+		// Wait for the writer (this is the only place the export waits on I/O)
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			isExportWaiting.store(true);
+			blockWritten.wait(lock, [this, index]() { return index - tail.load() < kBlockCount; });
+			isExportWaiting.store(false);
+		}
+		stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		stallCount++;
+	}
+
+	Block& block = blocks[index % kBlockCount];
+	setp(block.data, block.data + kBlockSize);
+}
+
+// A block is full
+AsyncWriter::int_type AsyncWriter::overflow(int_type c)
+{
+	int_type result = traits_type::not_eof(c);
+	if (!isOpen)
+	{
+		result = traits_type::eof();
+	}
+	else
+	{
+		// Hand over the full block and continue in the next one
+		Publish();
+		Acquire();
+
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+	}
+
+	return result;
+}
+
+// Flushing doesn't force a partial block out (that would produce lots of small writes), blocks are handed over when
+// they're full or the writer is closed
+int AsyncWriter::sync()
+{
+	return 0;
+}
+
+// Writer thread: writes blocks as they're handed over
+void AsyncWriter::Write()
+{
+	size_t index = tail.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		// Wait for a block (or for the export to finish)
+		if (index == head.load(std::memory_order_acquire) && !isClosing.load(std::memory_order_acquire))
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			isWriterWaiting.store(true);
+			blockPublished.wait(lock, [this, index]() { return index < head.load() || isClosing.load(); });
+			isWriterWaiting.store(false);
+		}
+
+		// Blocks are handed over before closing starts, so we're done once they're all written
+		if (index == head.load(std::memory_order_acquire))
+		{
+			break;
+		}
+
+		// Write the block
+		const Block& block = blocks[index % kBlockCount];
+		WriteBlock(block.data, block.size);
+
+		// The export may reuse the block
+		index++;
+		tail.store(index);
+		Wake(isExportWaiting, blockWritten);
+	}
+
+	Finish();
+	file.flush();
+	if (!file)
+	{
+		hasFailed = true;
+	}
+}
+
+// Write a block to the file (called on the writer thread)
+void AsyncWriter::WriteBlock(const char* data, size_t size)
+{
+	if (!file.write(data, size))
+	{
+		hasFailed = true;
+	}
+}
+
+// Write anything that follows the last block (called on the writer thread)
+void AsyncWriter::Finish()
+{
+}
+
+// Time the export waited for a free block (here and in the copy)
+double AsyncWriter::GetStallSeconds()
+{
+	return stallSeconds + FileWriter::GetStallSeconds();
+}
+
+// Report writer statistics
+void AsyncWriter::DebugInfo(std::ostream& out)
+{
+	out << "//   Output blocks = " << blockCount << ", bytes = " << byteCount <<
+		", stalls = " << stallCount << " (" << setiosflags(ios::fixed) << setprecision(3) << stallSeconds << "s)" << endl;
+
+	// Include the copy's statistics
+	if (GetCopy())
+	{
+		GetCopy()->DebugInfo(out);
+	}
+}
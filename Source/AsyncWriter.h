@@ -0,0 +1,101 @@
+// AsyncWriter.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include "IllustratorSDK.h"
+#include "FileWriter.h"
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace CanvasExport
+{
+	/// Output sink that writes a file on its own thread, so the export only waits for the disk (or network share)
+	/// when all of its blocks are full
+	/// Filled blocks are handed to the writer thread through a lock-free single-producer/single-consumer ring
+	/// Either side only takes a lock to sleep while the ring is full (export) or empty (writer), and to wake the other side
+	/// when it's sleeping
+	class AsyncWriter : public FileWriter
+	{
+	private:
+
+		static const size_t		kBlockSize = 64 * 1024;	// Size of each block (in bytes)
+		static const size_t		kBlockCount = 8;		// Number of blocks in the ring
+
+		/// A block of output
+		struct Block
+		{
+			char				data[kBlockSize];		// Output bytes
+			size_t				size;					// Number of bytes used
+		};
+
+		Block*					blocks;					// Ring of blocks
+		std::atomic<size_t>		head;					// Number of blocks handed to the writer (only changed by the export thread)
+		std::atomic<size_t>		tail;					// Number of blocks written (only changed by the writer thread)
+		std::atomic<bool>		isClosing;				// Set once the last block has been handed over
+		std::mutex				mutex;					// Held while deciding to sleep, and while waking a sleeping thread
+		std::condition_variable	blockPublished;			// Signaled when a block is handed over (or closing starts)
+		std::condition_variable	blockWritten;			// Signaled when a block has been written
+		std::atomic<bool>		isWriterWaiting;		// Is the writer (about to be) waiting for a block?
+		std::atomic<bool>		isExportWaiting;		// Is the export (about to be) waiting for a free block?
+		std::thread				writer;					// Writer thread
+		bool					isOpen;					// Is the file open?
+
+		void					Publish();
+		void					Acquire();
+		void					Write();
+		void					Wake(const std::atomic<bool>& isWaiting, std::condition_variable& condition);
+
+	protected:
+
+		std::ofstream			file;					// File being written (only used by the writer thread while it runs)
+		std::ios::openmode		openMode;				// How the file is opened
+		std::atomic<bool>		hasFailed;				// Did a write fail?
+
+		virtual void			WriteBlock(const char* data, size_t size);
+		virtual void			Finish();
+		int_type				overflow(int_type c) override;
+		int						sync() override;
+
+	public:
+
+		AsyncWriter();
+		~AsyncWriter();
+
+		double					stallSeconds;			// Time the export waited for a free block
+		unsigned int			stallCount;				// Number of times the export waited
+		unsigned int			blockCount;				// Number of blocks handed to the writer
+		uint64_t				byteCount;				// Number of bytes handed to the writer
+
+		bool					Open(const std::string& path) override;
+		bool					Close() override;
+		double					GetStallSeconds() override;
+		void					DebugInfo(std::ostream& out) override;
+
+	};
+}
+
+#endif
@@ -50,17 +50,28 @@ Canvas::Canvas(const std::string& id, DocumentResources* documentResources)
 {
 	// Initialize Canvas
 	this->documentResources = documentResources;
+	this->context = documentResources->context;
 	this->id = id;
 	this->width = 0.0f;
 	this->height = 0.0f;
 	this->isHidden = false;
 	this->contextName = "";
 	this->currentState = NULL;
+	this->stateCount = 0;
 	this->usePathfinderStyle = false;
 	this->renderMode = RM_Painter;
+	this->rasterDensities = 1;
+	this->textOutlines = false;
+	this->isDefinition = false;
+	this->textGroupOpen = false;
+	this->reportGroup = NULL;
 
 	// Push the first drawing state
 	PushState();
+
+	// Canvas default font
+	this->currentState->fontName = documentResources->strings.Intern("sans-serif");
+	this->currentState->fontStyleName = documentResources->strings.Intern("Regular");
 }
 
 Canvas::~Canvas()
@@ -71,67 +82,73 @@ Canvas::~Canvas()
 // Copies values from prior state as defaults for new state
 void Canvas::PushState()
 {
-	// New context drawing state
-	State state;
+	// Need another slot? (slots from earlier pushes are reused, so this only happens at a new maximum depth)
+	if (stateCount == states.size())
+	{
+		states.push_back(State());
+	}
 
 	// Is there already a state on the stack?
-	if (!states.empty())
+	if (stateCount > 0)
 	{
 		// Copy current state
-		state = states[(states.size() - 1)];
+		states[stateCount] = states[(stateCount - 1)];
+	}
+	else
+	{
+		// Start from the defaults
+		states[stateCount] = State();
 	}
-
-	// Add state
-	states.push_back(state);
 
 	// Set "current" state
-	currentState = &states.back();
+	currentState = &states[stateCount];
+	stateCount++;
 }
 
 void Canvas::PopState()
 {
-	// Remove last state
-	states.pop_back();
+	// Remove last state (its slot is kept for the next push)
+	stateCount--;
 
 	// Set "current" state
-	currentState = &states.back();
+	currentState = &states[(stateCount - 1)];
 }
 
 // Report canvas information
 void Canvas::DebugInfo()
 {
-	outFile << "// Canvas Info" << endl;
-	outFile << "//   id = " << this->id << endl;
-	outFile << "//   width = " << setiosflags(ios::fixed) << setprecision(2) << this->width << endl;
-	outFile << "//   height = " << setiosflags(ios::fixed) << setprecision(2) << this->height << endl;
-	outFile << "//   isHidden = " << this->isHidden << endl;
-	outFile << "//   contextName = " << this->contextName << endl;
-	outFile << "//   states = " << this->states.size() << endl;
+	context->out << "// Canvas Info" << endl;
+	context->out << "//   id = " << this->id << endl;
+	context->out << "//   width = " << setiosflags(ios::fixed) << setprecision(2) << this->width << endl;
+	context->out << "//   height = " << setiosflags(ios::fixed) << setprecision(2) << this->height << endl;
+	context->out << "//   isHidden = " << this->isHidden << endl;
+	context->out << "//   contextName = " << this->contextName << endl;
+	context->out << "//   states = " << this->stateCount << endl;
 
 	// Report states
-	for (unsigned int i = 0; i < states.size(); i++)
+	for (unsigned int i = 0; i < stateCount; i++)
 	{
 		// Report state information
-		states[i].DebugInfo();
+		states[i].DebugInfo(context->out, documentResources->strings);
 	}
 }
 
 void Canvas::Render()
 {
 	// Start canvas tag
-	outFile << "<canvas id=\"" << id << "\" " << endl;
+	context->out << "<canvas id=\"" << id << "\" " << endl;
 
 	// Is this canvas hidden?
 	if (isHidden)
 	{
-		if (!debug)
+		if (!context->debug)
 		{
-			outFile << "style=\"display: none\" ";
+			context->out << "style=\"display: none\" ";
 		}
 	}
 
 	// Output ID and dimensions
-	outFile << "width=\"" << (int)ceil(width) << "\" height=\"" << (int)ceil(height) << "\"></canvas>";
+	context->out << "width=\"" << (int)ceil(width) << "\" height=\"" << (int)ceil(height) << "\"></canvas>";
 }
 
 void Canvas::RenderImages()
@@ -142,6 +159,13 @@ void Canvas::RenderImages()
 // Render an Illustrator art object
 // (including siblings and children)
 void Canvas::RenderArt(AIArtHandle artHandle, unsigned int depth)
+{
+	// Walk the art in painter order (see Enter, GetChildren and Leave)
+	documentResources->traversal.Run(*this, artHandle, depth, ArtTraversal::kPainterOrder);
+}
+
+// Render an art object, returns true if its children should be rendered next
+bool Canvas::Enter(AIArtHandle artHandle, unsigned int& depth)
 {
 	// Simple way to describe blending modes for debugging purposes
 	// See: http://help.adobe.com/en_US/Illustrator/14.0/WS714a382cdf7d304e7e07d0100196cbc5f-64e0a.html
@@ -151,257 +175,261 @@ void Canvas::RenderArt(AIArtHandle artHandle, unsigned int depth)
 		"Exclusion", "Hue", "Saturation", "Color", "Luminosity", "Num"
 	};
 
-	// Start by gathering art and its siblings
-	std::vector<AIArtHandle> artHandles;
-	bool hasClipIndex = false;
-	size_t clipIndex = 0;
-
-	do
-	{
-		// Get type (needed for kPluginArt/Pathfinder clip test)
-		short type = 0;
-		sAIArt->GetArtType(artHandle, &type);
+	// Render children next?
+	bool renderChildren = false;
 
-		// Get the path style
-		AIPathStyle style;
-		sAIPathStyle->GetPathStyle(artHandle, &style);
+	// Art properties
+	ArtInfoCache& artInfo = documentResources->artInfo;
 
-		// Is this kPluginArt?
-		if (type == kPluginArt)
-		{
-			// Determine if this plug-in art is clipping
-			AIBoolean clipping = false;
-			sAIPluginGroup->GetPluginArtClipping(artHandle, &clipping);
+	// Is this art visible?
+	AIBoolean isArtVisible = !artInfo.IsHidden(artHandle);
 
-			// Is it clipping?
-			if (clipping)
-			{
-				// Remember where the clipping path is
-				clipIndex = artHandles.size();
-				hasClipIndex = true;
-			}
-		}
-		else
+	// Only render if art is visible
+	if (isArtVisible)
+	{
+		// Attribute a top-level group's output (children of the layer group are at depth 2)
+		if (context->report && !reportGroup && depth == 2 &&
+			context->report->IsInLayer() && artInfo.GetType(artHandle) == kGroupArt)
 		{
-			// Not kPluginArt, so check style attribute
-			if (style.clip)
-			{
-				// Remember where the clipping path is
-				clipIndex = artHandles.size();
-				hasClipIndex = true;
-			}
+			context->report->Begin("group", artInfo.GetUTF8Name(artHandle));
+			reportGroup = artHandle;
 		}
 
-		// Add this art handle
-		artHandles.push_back(artHandle);
+		// Add name to breadcrumbs
+		AddBreadcrumb(artHandle, depth);
 
-		// Find the next sibling
-		sAIArt->GetArtSibling(artHandle, &artHandle);
-	} while (artHandle != nil);
+		// Do we need to rasterize this art?
+		AIBoolean rasterizeArt = false;
 
-	// Did we find a clipping path?
-	if (hasClipIndex)
-	{
-		// Remember the clip art handle
-		AIArtHandle clipArtHandle = artHandles[clipIndex];
+		// Does this art have an associated opacity mask?
+		AIMaskRef mask;
+		sAIMask->GetMask(artHandle, &mask);
 
-		// Shift everything from the clip "up" by 1
-		for (size_t i = clipIndex; i < (artHandles.size() - 1); i++)
+		// Did we find a mask?
+		if (mask != NULL)
 		{
-			artHandles[i] = artHandles[i + 1];
+			// Output a warning
+			context->out << "// This artwork uses an unsupported opacity mask" << endl;
+
+			// Rasterize the art
+			rasterizeArt = true;
 		}
 
-		// Move the clip art handle to the end
-		artHandles[(artHandles.size() - 1)] = clipArtHandle;
-	}
+		// Parse the art styles, including drop shadow information
+		ASInt32 postEffectCount = 0;
+		AIBlendingMode blendingMode = 0;
+		AIBoolean hasDropShadow = false;
+		DropShadow dropShadow;
+		ParseArtStyle(artHandle, postEffectCount, blendingMode, hasDropShadow, dropShadow);
 
-	// Loop through all art in this layer
-	// Do it backwards, because of canvas "painter model"
-	for (size_t i = artHandles.size(); i > 0; i--)
-	{
-		artHandle = artHandles[(i - 1)];
+		// Anything we can't convert and should rasterize?
+		if (postEffectCount > 1)
+		{
+			// Rasterize this art
+			rasterizeArt = true;
+
+			// Don't bother with the drop shadow, since we can't convert the combination of effects
+			hasDropShadow = false;
+		}
+		else if (postEffectCount == 1)
+		{
+			// Do we have anything other than a drop shadow?
+			if (!hasDropShadow)
+			{
+				// Rasterize this art
+				rasterizeArt = true;
+			}
+		}
 
-		// Is this art visible?
-		AIBoolean isArtVisible = false;
-		ai::int32 attr = 0;
-		sAIArt->GetArtUserAttr(artHandle, kArtHidden, &attr);
-		isArtVisible = !((attr &kArtHidden) == kArtHidden);
+		// If the blending mode is anything other than normal, we should output a warning
+		if (blendingMode != kAINormalBlendingMode)
+		{
+			// Output a warning
+			context->out << "// This artwork uses an unsupported \"" << std::string(blendingModes[blendingMode]) << "\" blending mode" << endl;
+		}
 
-		// Only render if art is visible
-		if (isArtVisible)
+		// Do we need to increase depth because of a drop shadow?
+		// (only for this art and its children, since siblings get the depth from the traversal)
+		if (hasDropShadow)
 		{
-			// Get art name
-			ai::UnicodeString artName;
-			AIBoolean isDefaultName = false;
-			sAIArt->GetArtName(artHandle, artName, &isDefaultName);
+			// Increase depth so we can maintain shadow context
+			depth++;
+		}
 
-			// Add name to breadcrumbs
-			AddBreadcrumb(artName.as_UTF8(), depth);
+		// Set state
+		// TODO: Should this only be done if the art is visible?
+		SetContextDrawingState(depth);
 
-			// Do we need to rasterize this art?
-			AIBoolean rasterizeArt = false;
+		// Render drop shadow info, if there is any
+		if (hasDropShadow)
+		{
+			RenderDropShadow(dropShadow);
+		}
 
-			// Does this art have an associated opacity mask?
-			AIMaskRef mask;
-			sAIMask->GetMask(artHandle, &mask);
+		// Get opacity
+		AIReal opacity = artInfo.GetOpacity(artHandle);
 
-			// Did we find a mask?
-			if (mask != NULL)
+		// Are we rasterizing this art?
+		if (rasterizeArt)
+		{
+			// Rasterize the art (naming the file after its content)
+			context->out << "// This unsupported artwork has been rasterized" << endl;
+			RenderUnsupportedArt(artHandle, "", depth);
+		}
+		else
+		{
+			// Is opacity different than current state?
+			if (opacity != currentState->globalAlpha)
 			{
-				// Output a warning
-				outFile << "// This artwork uses an unsupported opacity mask" << endl;
+				// Assign new global alpha
+				currentState->globalAlpha = opacity;
 
-				// Rasterize the art
-				rasterizeArt = true;
+				// Change global alpha (based on the "base" alpha value)
+				context->out << contextName << ".globalAlpha = " << context->alphaName << " * " <<
+					setiosflags(ios::fixed) << setprecision(2) << currentState->globalAlpha << ";" << endl;
 			}
 
-			// Parse the art styles, including drop shadow information
-			ASInt32 postEffectCount = 0;
-			AIBlendingMode blendingMode = 0;
-			AIBoolean hasDropShadow = false;
-			DropShadow dropShadow;
-			ParseArtStyle(artHandle, postEffectCount, blendingMode, hasDropShadow, dropShadow);
-
-			// Anything we can't convert and should rasterize?
-			if (postEffectCount > 1)
+			// Get type
+			short type = artInfo.GetType(artHandle);
+			if (context->debug)
 			{
-				// Rasterize this art
-				rasterizeArt = true;
+				context->out << "// Art type = " << std::string(m_artTypes[type]) << " (" << type << ")" << endl;
+			}
 
-				// Don't bother with the drop shadow, since we can't convert the combination of effects
-				hasDropShadow = false;
+			// Process based on art type
+			switch (type)
+			{
+			case kGroupArt:
+			{
+				// Render this sub-group
+				renderChildren = true;
+				break;
 			}
-			else if (postEffectCount == 1)
+			case kPluginArt:
 			{
-				// Do we have anything other than a drop shadow?
-				if (!hasDropShadow)
-				{
-					// Rasterize this art
-					rasterizeArt = true;
-				}
+				// Render the result group
+				RenderPluginArt(artHandle, depth);
+				renderChildren = true;
+				break;
 			}
-
-			// If the blending mode is anything other than normal, we should output a warning
-			if (blendingMode != kAINormalBlendingMode)
+			case kSymbolArt:
 			{
-				// Output a warning
-				outFile << "// This artwork uses an unsupported \"" << std::string(blendingModes[blendingMode]) << "\" blending mode" << endl;
+				RenderSymbolArt(artHandle, depth);
+				break;
 			}
-
-			// Do we need to increase depth because of a drop shadow?
-			if (hasDropShadow)
+			case kCompoundPathArt:
 			{
-				// Increase depth so we can maintain shadow context
-				depth++;
+				// Render the sub-paths (Leave applies the style)
+				RenderCompoundPathArt(artHandle, depth);
+				renderChildren = true;
+				break;
 			}
-
-			// Set state
-			// TODO: Should this only be done if the art is visible?
-			SetContextDrawingState(depth);
-
-			// Render drop shadow info, if there is any
-			if (hasDropShadow)
+			case kPathArt:
 			{
-				RenderDropShadow(dropShadow);
+				RenderPathArt(artHandle, depth);
+				break;
 			}
-
-			// Get opacity
-			AIReal opacity = sAIBlendStyle->GetOpacity(artHandle);
-
-			// Are we rasterizing this art?
-			if (rasterizeArt)
+			case kTextFrameArt:
 			{
-				// Rasterize the art
-				std::string fileName = GetUniqueFileName(documentResources->folderPath, "image", ".png");
-				outFile << "// This unsupported artwork has been rasterized" << endl;
-				RenderUnsupportedArt(artHandle, fileName, depth);
+				RenderTextFrameArt(artHandle, depth);
+				break;
 			}
-			else
+			case kPlacedArt:
 			{
-				// Is opacity different than current state?
-				if (opacity != currentState->globalAlpha)
-				{
-					// Assign new global alpha
-					currentState->globalAlpha = opacity;
-
-					// Change global alpha (based on the "base" alpha value)
-					outFile << contextName << ".globalAlpha = alpha * " <<
-						setiosflags(ios::fixed) << setprecision(2) << currentState->globalAlpha << ";" << endl;
-				}
-
-				// Get type
-				short type = 0;
-				sAIArt->GetArtType(artHandle, &type);
-				if (debug)
-				{
-					outFile << "// Art type = " << std::string(m_artTypes[type]) << " (" << type << ")" << endl;
-				}
-
-				// Process based on art type
-				switch (type)
-				{
-				case kGroupArt:
-				{
-					// Render this sub-group
-					RenderGroupArt(artHandle, depth);
-					break;
-				}
-				case kPluginArt:
-				{
-					RenderPluginArt(artHandle, depth);
-					break;
-				}
-				case kSymbolArt:
-				{
-					RenderSymbolArt(artHandle, depth);
-					break;
-				}
-				case kCompoundPathArt:
-				{
-					RenderCompoundPathArt(artHandle, depth);
-					break;
-				}
-				case kPathArt:
-				{
-					RenderPathArt(artHandle, depth);
-					break;
-				}
-				case kTextFrameArt:
-				{
-					RenderTextFrameArt(artHandle, depth);
-					break;
-				}
-				case kPlacedArt:
-				{
-					RenderPlacedArt(artHandle, depth);
-					break;
-				}
-				case kRasterArt:
-				{
-					RenderRasterArt(artHandle);
-					break;
-				}
-				case kMeshArt:
-				{
-					// Get a unique file name
-					std::string fileName = GetUniqueFileName(documentResources->folderPath, "image", ".png");
-					RenderUnsupportedArt(artHandle, fileName, depth);
-					break;
-				}
-				}
+				RenderPlacedArt(artHandle, depth);
+				break;
 			}
-
-			// Were we rendering a drop shadow?
-			if (hasDropShadow)
+			case kRasterArt:
+			{
+				RenderRasterArt(artHandle, depth);
+				break;
+			}
+			case kMeshArt:
 			{
-				// Decrease depth to restore context
-				depth--;
+				// Rasterize the art (naming the file after its content)
+				RenderUnsupportedArt(artHandle, "", depth);
+				break;
 			}
+			}
+		}
 
+		// Done with this art? (otherwise, Leave removes it)
+		if (!renderChildren)
+		{
 			// Remove from breadcrumb
 			RemoveBreadcrumb();
+			EndReportGroup(artHandle);
+		}
+	}
+
+	return renderChildren;
+}
+
+// Returns the children of art that Enter chose to render children for
+bool Canvas::GetChildren(AIArtHandle artHandle, unsigned int depth, unsigned int pass, AIArtHandle& firstChild, unsigned int& childDepth)
+{
+	// Only one list of children
+	bool hasChildren = (pass == 0);
+	if (hasChildren)
+	{
+		// Get type
+		short type = documentResources->artInfo.GetType(artHandle);
+
+		// Process based on art type
+		switch (type)
+		{
+		case kGroupArt:
+		{
+			// Get the first art element in the group (one level deeper)
+			sAIArt->GetArtFirstChild(artHandle, &firstChild);
+			childDepth = depth + 1;
+			break;
+		}
+		case kPluginArt:
+		{
+			// Get the result art handle
+			AIArtHandle resultArtHandle = nil;
+			sAIPluginGroup->GetPluginArtResultArt(artHandle, &resultArtHandle);
+
+			// Get the first art element in the result group
+			// Stay at this depth, so we don't create a unique canvas context
+			sAIArt->GetArtFirstChild(resultArtHandle, &firstChild);
+			childDepth = depth;
+			break;
+		}
+		case kCompoundPathArt:
+		{
+			// Get the first art element in the compound path
+			sAIArt->GetArtFirstChild(artHandle, &firstChild);
+			childDepth = depth;
+			break;
 		}
+		default:
+		{
+			hasChildren = false;
+			break;
+		}
+		}
+	}
+
+	return hasChildren;
+}
+
+// Finishes art after its children have been rendered
+void Canvas::Leave(AIArtHandle artHandle, unsigned int depth)
+{
+	// Get type
+	short type = documentResources->artInfo.GetType(artHandle);
+
+	// Compound paths are styled after their sub-paths
+	if (type == kCompoundPathArt)
+	{
+		FinishCompoundPathArt(artHandle, depth);
 	}
+
+	// Remove from breadcrumb
+	RemoveBreadcrumb();
+	EndReportGroup(artHandle);
 }
 
 // Parse the art styles (including Live Effects) associated with this artwork
@@ -417,13 +445,51 @@ void Canvas::ParseArtStyle(AIArtHandle artHandle, ASInt32& postEffectCount, AIBl
 //		"GraphDesignRefType", "BlendStyleType", "GraphicObjectType"
 //	};
 
-	// Does this artwork have a drop shadow?
-	hasDropShadow = false;
-
 	// Get the style for this art handle
 	AIArtStyleHandle artStyle = NULL;
 	sAIArtStyle->GetArtStyle(artHandle, &artStyle);
 
+	// Get the blending mode (it belongs to the art, not the style)
+	blendingMode = documentResources->artInfo.GetBlendingMode(artHandle);
+
+	// Parse the style, unless other art already used it
+	const ParsedArtStyle* parsedStyle = documentResources->artStyles.Find(artStyle);
+	if (!parsedStyle)
+	{
+		ParsedArtStyle newStyle;
+		ParseLiveEffects(artStyle, newStyle);
+		parsedStyle = &documentResources->artStyles.Add(artStyle, newStyle);
+	}
+
+	// Report the effects
+	if (context->debug)
+	{
+		for (size_t i = 0; i < parsedStyle->effectNames.size(); i++)
+		{
+			context->out << "// Live Effect name = " << parsedStyle->effectNames[i] << endl;
+
+			// A Live Effect we don't recognize
+			if (parsedStyle->effectNames[i] != "Adobe Drop Shadow")
+			{
+				context->out << "//     Unsupported Live Effect: \"" << parsedStyle->effectNames[i] << "\"" << endl;
+			}
+		}
+	}
+
+	// Return the results
+	postEffectCount = parsedStyle->postEffectCount;
+	hasDropShadow = parsedStyle->hasDropShadow;
+	dropShadow = parsedStyle->dropShadow;
+}
+
+// Parse the Live Effects of an art style
+void Canvas::ParseLiveEffects(AIArtStyleHandle artStyle, ParsedArtStyle& parsedStyle)
+{
+	// Nothing found yet
+	parsedStyle.postEffectCount = 0;
+	parsedStyle.hasDropShadow = false;
+	DropShadow& dropShadow = parsedStyle.dropShadow;
+
 	// Create a new style parser 
 	AIStyleParser parser(NULL);
 	sAIArtStyleParser->NewParser(&parser);
@@ -431,18 +497,11 @@ void Canvas::ParseArtStyle(AIArtHandle artHandle, ASInt32& postEffectCount, AIBl
 	// Parse the art style
 	sAIArtStyleParser->ParseStyle(parser, artStyle);
 
-	// Get blend field
-	AIParserBlendField blendField;
-	sAIArtStyleParser->GetStyleBlendField(parser, &blendField);
-
-	// Get the blending mode
-	blendingMode = sAIBlendStyle->GetBlendingMode(artHandle);
-
 	// How many post-effects are attached to this art style?
-	postEffectCount = sAIArtStyleParser->CountPostEffects(parser);
+	parsedStyle.postEffectCount = sAIArtStyleParser->CountPostEffects(parser);
 
 	// Loop through all post-effect art styles
-	for (ASInt32 postIndex = 0; (postIndex < postEffectCount); ++postIndex)
+	for (ASInt32 postIndex = 0; (postIndex < parsedStyle.postEffectCount); ++postIndex)
 	{
 		// Parse the Live Effects
 		AIParserLiveEffect liveEffect;
@@ -457,10 +516,7 @@ void Canvas::ParseArtStyle(AIArtHandle artHandle, ASInt32& postEffectCount, AIBl
 		// TODO: Do we need to release this memory somewhere? Or does the fact that we retrieved the handle via the AIArtStyleParser do the trick
 		//       (since we clean-up the parser later)?
 		sAILiveEffect->GetLiveEffectName(liveEffectHandle, &liveEffectName);
-		if (debug)
-		{
-			outFile << "// Live Effect name = " << liveEffectName << endl;
-		}
+		parsedStyle.effectNames.push_back(liveEffectName);
 
 		// Check to see if the name is �Adobe Drop Shadow�
 		if (strcmp(liveEffectName, "Adobe Drop Shadow") == 0)
@@ -472,7 +528,7 @@ void Canvas::ParseArtStyle(AIArtHandle artHandle, ASInt32& postEffectCount, AIBl
 			dropShadow.opac = 1.0f;
 
 			// Note that this artwork has a drop shadow assigned
-			hasDropShadow = true;
+			parsedStyle.hasDropShadow = true;
 
 			// Obtain the parameters dictionary
 			AILiveEffectParameters params;
@@ -544,14 +600,6 @@ void Canvas::ParseArtStyle(AIArtHandle artHandle, ASInt32& postEffectCount, AIBl
 				sAIDictionaryIterator->Release(dictionaryIter);
 			}
 		}
-		else
-		{
-			// A Live Effect we don't recognize
-			if (debug)
-			{
-				outFile << "//     Unsupported Live Effect: \"" << liveEffectName << "\"" << endl;
-			}
-		}
 	}
 
 	// Dispose the art style parser
@@ -562,28 +610,28 @@ void Canvas::ParseArtStyle(AIArtHandle artHandle, ASInt32& postEffectCount, AIBl
 void Canvas::SetContextDrawingState(unsigned int depth)
 {
 	// Are we restoring state?
-	if (depth < states.size())
+	if (depth < stateCount)
 	{
 		// Restore canvas state back to requested depth
-		for (size_t i = states.size(); i > depth; i--)
+		for (size_t i = stateCount; i > depth; i--)
 		{
 			// Pop state off the stack
 			PopState();
 
 			// Restore canvas state
-			outFile << contextName << ".restore();" << endl;
+			context->out << contextName << ".restore();" << endl;
 		}
 	}
-	else if (depth > states.size())
+	else if (depth > stateCount)
 	{
 		// Save canvas state to requested depth
-		for (size_t i = states.size(); i < depth; i++)
+		for (size_t i = stateCount; i < depth; i++)
 		{
 			// Push state on the stack
 			PushState();
 
 			// Save canvas state
-			outFile << contextName << ".save();" << endl;
+			context->out << contextName << ".save();" << endl;
 		}
 	}
 }
@@ -596,27 +644,39 @@ void Canvas::RenderDropShadow(const DropShadow& dropShadow)
 	// Allocate memory for shadow fill color value string
 	std::string shadowColor;
 	shadowColor = GetColor(dropShadow.shadowStyle.color, dropShadow.opac);
-	outFile << contextName << ".shadowColor = " << shadowColor << ";" << endl;
+	context->out << contextName << ".shadowColor = " << documentResources->styles.Color(shadowColor) << ";" << endl;
 
 	// Shadow offsets
-	outFile << contextName << ".shadowOffsetX = " << setiosflags(ios::fixed) << setprecision(1) << dropShadow.horz << ";" << endl;
-	outFile << contextName << ".shadowOffsetY = " << setiosflags(ios::fixed) << setprecision(1) << dropShadow.vert << ";" << endl;
+	context->out << contextName << ".shadowOffsetX = " << setiosflags(ios::fixed) << setprecision(1) << dropShadow.horz << ";" << endl;
+	context->out << contextName << ".shadowOffsetY = " << setiosflags(ios::fixed) << setprecision(1) << dropShadow.vert << ";" << endl;
 
 	// Shadow blur
 	// TODO: Note that it appears that we have to double the Illustrator value to achieve equivalent results with <canvas>
-	outFile << contextName << ".shadowBlur = " << setiosflags(ios::fixed) << setprecision(1) << (dropShadow.blur * 2.0f) << ";" << endl;
+	context->out << contextName << ".shadowBlur = " << setiosflags(ios::fixed) << setprecision(1) << (dropShadow.blur * 2.0f) << ";" << endl;
 }
 
 // There's no direct equivalent, so just rasterize to a bitmap
+// The file is named after its content, unless a file name is passed
 void Canvas::RenderUnsupportedArt(AIArtHandle artHandle, const std::string& fileName, unsigned int depth)
 {
 	(void)depth;
 
-	// Full path to file
-	std::string fullPath = documentResources->folderPath + fileName;
+	// Base name for the file (and its variants)
+	std::string imageFileName = fileName;
+	std::string baseName = fileName.empty() ? "image" : fileName.substr(0, fileName.find_last_of('.'));
+
+	// Full path to file (a temporary file, if we still need to name it)
+	std::string fullPath = documentResources->folderPath + (fileName.empty() ? GetTempAssetName(".png") : fileName);
 
 	// Rasterize to a 32-bit PNG that includes alpha
-	RasterizeArtToPNG(artHandle, fullPath);
+	RasterizeArtToPNG(artHandle, fullPath, 1.0f);
+
+	// Name the file after its content?
+	if (fileName.empty())
+	{
+		imageFileName = NameFileByContent(documentResources->folderPath, fullPath, baseName, ".png");
+		fullPath = documentResources->folderPath + imageFileName;
+	}
 
 	// Get the actual dimensions of the rasterized PNG file
 	// Note that the AIArtOptSuite functions seems to rasterize to different sizes, which is why we do this step
@@ -624,29 +684,35 @@ void Canvas::RenderUnsupportedArt(AIArtHandle artHandle, const std::string& file
 	unsigned int imgHeight = 0;
 	GetPNGDimensions(fullPath, imgWidth, imgHeight);
 
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Actual PNG file dimensions, width = " << imgWidth << ", height = " << imgHeight << endl;
+		context->out << "// Actual PNG file dimensions, width = " << imgWidth << ", height = " << imgHeight << endl;
 	}
 
-	// Add a new image
-	Image* image = documentResources->images.Add(fileName);
+	// Add a new image (or find the image with identical content)
+	Image* image = documentResources->images.Add(imageFileName);
 
 	// Image is NOT an absolute path
 	image->pathIsAbsolute = false;
 
+	// Remember the 1x size (higher density variants are drawn at this size)
+	image->width = imgWidth;
+	image->height = imgHeight;
+
+	// Rasterize higher density variants (unless identical art already did)
+	if (image->variants.empty())
+	{
+		RasterizeArtVariants(artHandle, image, baseName);
+	}
+
 	// Get image "alt" name
-	ai::UnicodeString artName;
-	AIBoolean isDefaultName = false;
-	sAIArt->GetArtName(artHandle, artName, &isDefaultName);
-	std::string cleanName = artName.as_Platform();
+	std::string cleanName = documentResources->artInfo.GetName(artHandle).as_Platform();
 	CleanFunction(cleanName);
 	CleanString(cleanName, false);
 	image->name = cleanName;
 
 	// Get the art bounding box (which includes transformations)
-	AIRealRect bounds;
-	sAIArt->GetArtBounds(artHandle, &bounds);
+	AIRealRect bounds = documentResources->artInfo.GetBounds(artHandle);
 
 	// Transform the art bounding box
 	TransformRect(bounds);
@@ -660,10 +726,56 @@ void Canvas::RenderUnsupportedArt(AIArtHandle artHandle, const std::string& file
 	image->DebugBounds(contextName, bounds);
 }
 
+// Rasterizes 2x, 3x, ... variants of an image (up to the requested number of pixel densities)
+// Variants are named after their content, like "image@2x-0123456789ab.png"
+void Canvas::RasterizeArtVariants(AIArtHandle artHandle, Image* image, const std::string& baseName)
+{
+	// Rasterize each density
+	for (unsigned int density = 2; density <= rasterDensities; density++)
+	{
+		// Rasterize to a temporary file
+		std::string tempPath = documentResources->folderPath + GetTempAssetName(".png");
+		RasterizeArtToPNG(artHandle, tempPath, (AIReal)density);
+
+		// Name the variant after its content
+		std::ostringstream variantBaseName;
+		variantBaseName << baseName << "@" << density << "x";
+		std::string variantName = NameFileByContent(documentResources->folderPath, tempPath, variantBaseName.str(), ".png");
+
+		// Add variant
+		image->variants.push_back(variantName);
+	}
+}
+
 // Given an art handle, rasterizes to a file at the given path
+// The scale multiplies the 72 DPI base resolution (2.0 rasterizes for 2x pixel density screens)
+// Art that was rasterized by a previous export (and hasn't changed since) is copied from the raster cache
+AIErr Canvas::RasterizeArtToPNG(AIArtHandle artHandle, const std::string& path, AIReal scale)
+{
+	AIErr result = kNoErr;
+
+	// Can this art be cached?
+	std::string cacheKey;
+	AIBoolean isCacheable = documentResources->rasterCache.GetKey(artHandle, scale, cacheKey);
+
+	// Rasterize, unless we already have the result
+	if (!isCacheable || !documentResources->rasterCache.Fetch(cacheKey, path))
+	{
+		// Rasterize, and keep the result for the next export
+		result = MakePNG(artHandle, path, scale);
+		if (isCacheable && !result)
+		{
+			documentResources->rasterCache.Store(cacheKey, path);
+		}
+	}
+
+	return result;
+}
+
+// Given an art handle, rasterizes to a file at the given path (using the image optimization suite)
 // NOTE: While width and height are passed, the resulting file is often of a different size, which negatively affects positioning
 // See discussion thread: http://forums.adobe.com/thread/603776?tstart=0
-void Canvas::RasterizeArtToPNG(AIArtHandle artHandle, const std::string& path)
+AIErr Canvas::MakePNG(AIArtHandle artHandle, const std::string& path, AIReal scale)
 {
 	ai::FilePath filePath;
 	filePath.Set(ai::UnicodeString(path));
@@ -688,13 +800,13 @@ void Canvas::RasterizeArtToPNG(AIArtHandle artHandle, const std::string& path)
 	params.versionOneSuiteParams.interlaced = false;
 	params.versionOneSuiteParams.numberOfColors = 16777216;
 	params.versionOneSuiteParams.transparentIndex = 0;
-	params.versionOneSuiteParams.resolution = 72.0f;
+	params.versionOneSuiteParams.resolution = 72.0f * scale;
 	params.versionOneSuiteParams.outAlpha = true;
-	params.versionOneSuiteParams.outWidth = (ASInt32)artWidth;
-	params.versionOneSuiteParams.outHeight = (ASInt32)artHeight;
+	params.versionOneSuiteParams.outWidth = (ASInt32)(artWidth * scale);
+	params.versionOneSuiteParams.outHeight = (ASInt32)(artHeight * scale);
 
 	//We assume that the basic resolution of illustrator is 72 dpi
-	AIReal resolutionRatio = 1.0f;
+	AIReal resolutionRatio = scale;
 	AIReal minDim = std::min(artWidth, artHeight) * resolutionRatio;
 	AIReal maxDim = std::max(artWidth, artHeight) * resolutionRatio;
 	AIReal ratio = 1;
@@ -739,6 +851,8 @@ void Canvas::RasterizeArtToPNG(AIArtHandle artHandle, const std::string& path)
 		if (!result)
 			result = tmpresult;
 	}
+
+	return result;
 }
 
 // Get PNG dimensions
@@ -918,98 +1032,245 @@ uint16_t Canvas::ReverseInt(uint16_t i)
 	return (c1 << 8) + c2;
 }
 
-void Canvas::ReportRasterRecordInfo(const AIRasterRecord& rasterRecord)
+// Returns the orientation tag of an APP1 segment's EXIF data (1, meaning "as stored," if there isn't one)
+static unsigned int GetEXIFOrientation(const std::vector<unsigned char>& exif)
 {
-	outFile << "// Raster Record Info" << endl;
-	outFile << "//   flags = " << rasterRecord.flags << endl;
-	outFile << "//   bounds = left:" << rasterRecord.bounds.left << ", top:" << rasterRecord.bounds.top <<
-		", right:" << rasterRecord.bounds.right << ", bottom:" << rasterRecord.bounds.bottom << endl;
-	outFile << "//   byteWidth = " << rasterRecord.byteWidth << endl;
-	outFile << "//   colorSpace = " << endl;
-	ReportColorSpaceInfo(rasterRecord.colorSpace);
-	outFile << "//   bitsPerPixel = " << rasterRecord.bitsPerPixel << endl;
-	outFile << "//   originalColorSpace = " << endl;
+	unsigned int orientation = 1;
 
-	// If originalColorSpace = -1, then raster hasn't been through the color converter
-	if (rasterRecord.originalColorSpace == -1)
-	{
-		outFile << "(hasn't been converted yet)";
-	}
-	else
-	{
-		ReportColorSpaceInfo(rasterRecord.originalColorSpace);
-	}
-}
-
-void Canvas::ReportColorSpaceInfo(ai::int16 colorSpace)
-{
-	// Simple way to describe color space types for debugging purposes
-	static const char *colorSpaces[] =
+	// "Exif" header, then a TIFF header (byte order, 42, offset of the first IFD)
+	if (exif.size() >= 14 && memcmp(&exif[0], "Exif\0\0", 6) == 0)
 	{
-		"kGrayColorSpace", "kRGBColorSpace", "kCMYKColorSpace"
-	};
+		const unsigned char* tiff = &exif[6];
+		size_t size = exif.size() - 6;
+		bool isBigEndian = (tiff[0] == 'M' && tiff[1] == 'M');
 
-	// Color space info
-	outFile << std::string(colorSpaces[colorSpace]) << " (" << colorSpace << ")";
+		// Read 16 and 32-bit values in the file's byte order
+		auto get16 = [tiff, isBigEndian](size_t at) -> unsigned int
+		{
+			return isBigEndian ? ((tiff[at] << 8) | tiff[at + 1]) : ((tiff[at + 1] << 8) | tiff[at]);
+		};
+		auto get32 = [get16, isBigEndian](size_t at) -> size_t
+		{
+			return isBigEndian ? (((size_t)get16(at) << 16) | get16(at + 2)) : (((size_t)get16(at + 2) << 16) | get16(at));
+		};
 
-	// Alpha?
-	if (colorSpace & kColorSpaceHasAlpha)
-	{
-		outFile << " with alpha";
+		// Look for the orientation tag (0x0112) in IFD0 (each entry is 12 bytes)
+		size_t ifd = get32(4);
+		if (ifd + 2 <= size)
+		{
+			unsigned int count = get16(ifd);
+			for (unsigned int i = 0; i < count && ifd + 2 + (i + 1) * 12 <= size; i++)
+			{
+				size_t entry = ifd + 2 + i * 12;
+				if (get16(entry) == 0x0112)
+				{
+					orientation = get16(entry + 8);
+					break;
+				}
+			}
+		}
 	}
-}
-
-void Canvas::RenderGroupArt(AIArtHandle artHandle, unsigned int depth)
-{
-	// Get the first art element in the group
-	AIArtHandle childArtHandle = nil;
-	sAIArt->GetArtFirstChild(artHandle, &childArtHandle);
 
-	// Render this sub-group
-	RenderArt(childArtHandle, depth + 1);
+	return orientation;
 }
 
-void Canvas::RenderPluginArt(AIArtHandle artHandle, unsigned int depth)
+// Get JPG pixel dimensions and number of color components
+// Walks the marker segments up to the first start-of-frame (SOF) marker, returns false if the file isn't a readable JPEG
+// Also returns the EXIF orientation (1 if the file doesn't have one)
+AIBoolean Canvas::GetJPGDimensions(const std::string& path, unsigned int& imgWidth, unsigned int& imgHeight, unsigned int& components, unsigned int& orientation)
 {
-	// For Illustrator plug-in art types, like "Compound Shape" and "Blend" 
-	// For simplicity, we render the "Result Group" (instead of the "Edit Group", which contains all of the original art)
+	AIBoolean found = false;
+	orientation = 1;
 
-	// What kind of plug-in art is this?
-	// TODO: Do we really need to allocate memory here? Or does the call do it for us?
-	char **pluginArtName = (char **)calloc(1024, sizeof(char));
-	sAIPluginGroup->GetPluginArtName(artHandle, pluginArtName);
-	if (debug)
-	{
-		outFile << "// Plug-in art name = " << std::string(*pluginArtName) << endl;
-	}
+#ifdef MAC_ENV
+	// JPG file handle
+	FILE *jpgFile = NULL;
 
-	// Is this the Pathfinder Suite? If so, we need to grab the style from this art handle
-	if (strcmp(*pluginArtName, "Pathfinder Suite") == 0)
-	{
-		// Set pathfinder style
-		sAIPathStyle->GetPathStyle(artHandle, &pathfinderStyle);
-		usePathfinderStyle = true;
+	// Open the JPG file for binary reading
+	jpgFile = fopen(path.c_str(), "rb");
+#endif
+#ifdef WIN_ENV
+	// JPG file handle
+	FILE *jpgFile = NULL;
 
-		// Determine if this plug-in art is clipping
-		AIBoolean clipping = false;
-		sAIPluginGroup->GetPluginArtClipping(artHandle, &clipping);
+	// Open the JPG file for binary reading
+	fopen_s(&jpgFile, path.c_str(), "rb");
+#endif
 
-		// Set clip on our "special style" so we know to clip later
-		pathfinderStyle.clip = clipping;
+	// Were we able to open the file?
+	if (jpgFile != NULL)
+	{
+		// Does it start with SOI (0xff, 0xd8)?
+		unsigned char marker[2];
+		if (fread(marker, 1, 2, jpgFile) == 2 && marker[0] == 0xff && marker[1] == 0xd8)
+		{
+			// Walk the segments
+			while (!found)
+			{
+				// Find the next marker (skipping fill bytes)
+				int c = fgetc(jpgFile);
+				if (c != 0xff)
+				{
+					break;
+				}
+				do
+				{
+					c = fgetc(jpgFile);
+				} while (c == 0xff);
+
+				// Start of scan, end of image, or end of file means there's no frame header to be found
+				if (c == EOF || c == 0xda || c == 0xd9)
+				{
+					break;
+				}
+
+				// Standalone markers have no length
+				if (c == 0x01 || (c >= 0xd0 && c <= 0xd7))
+				{
+					continue;
+				}
+
+				// Get segment length (big endian, includes the length itself)
+				unsigned char lengthBytes[2];
+				if (fread(lengthBytes, 1, 2, jpgFile) != 2)
+				{
+					break;
+				}
+				unsigned int length = (lengthBytes[0] << 8) + lengthBytes[1];
+				if (length < 2)
+				{
+					break;
+				}
+
+				// Start of frame? (0xc4, 0xc8 and 0xcc share the range, but aren't frames)
+				if (c >= 0xc0 && c <= 0xcf && c != 0xc4 && c != 0xc8 && c != 0xcc)
+				{
+					// Precision (1), height (2), width (2), components (1)
+					unsigned char frame[6];
+					if (fread(frame, 1, 6, jpgFile) == 6)
+					{
+						imgHeight = (frame[1] << 8) + frame[2];
+						imgWidth = (frame[3] << 8) + frame[4];
+						components = frame[5];
+						found = (imgWidth > 0 && imgHeight > 0);
+					}
+					break;
+				}
+
+				// EXIF data? (APP1)
+				if (c == 0xe1)
+				{
+					std::vector<unsigned char> exif(length - 2);
+					if (exif.empty() || fread(&exif[0], 1, exif.size(), jpgFile) != exif.size())
+					{
+						break;
+					}
+					orientation = GetEXIFOrientation(exif);
+					continue;
+				}
+
+				// Skip this segment
+				if (fseek(jpgFile, length - 2, SEEK_CUR) != 0)
+				{
+					break;
+				}
+			}
+		}
+
+		// Close the JPG file
+		fclose(jpgFile);
 	}
 
-	AIArtHandle resultArtHandle = nil;
+	return found;
+}
 
-	// Get the result art handle
-	sAIPluginGroup->GetPluginArtResultArt(artHandle, &resultArtHandle);
+// Is the file a raster was embedded from still the file it was embedded from?
+// Compares the file information recorded in the art with the file on disk (rasters without a recorded file can't be checked)
+AIBoolean Canvas::IsRasterFileUnchanged(AIArtHandle artHandle)
+{
+	SPPlatformFileInfo artFileInfo;
+	SPPlatformFileInfo fileInfo;
+	AIErr result = sAIRaster->GetRasterFileInfoFromArt(artHandle, &artFileInfo);
+	if (!result)
+	{
+		result = sAIRaster->GetRasterFileInfoFromFile(artHandle, &fileInfo);
+	}
 
-	// Get the first art element in the result group
-	AIArtHandle childArtHandle = nil;
-	sAIArt->GetArtFirstChild(resultArtHandle, &childArtHandle);
+	return (!result && GetModificationTime(artFileInfo) == GetModificationTime(fileInfo));
+}
 
-	// Render this sub-group
-	// Stay at this depth, so we don't create a unique canvas context
-	RenderArt(childArtHandle, depth);
+void Canvas::ReportRasterRecordInfo(const AIRasterRecord& rasterRecord)
+{
+	context->out << "// Raster Record Info" << endl;
+	context->out << "//   flags = " << rasterRecord.flags << endl;
+	context->out << "//   bounds = left:" << rasterRecord.bounds.left << ", top:" << rasterRecord.bounds.top <<
+		", right:" << rasterRecord.bounds.right << ", bottom:" << rasterRecord.bounds.bottom << endl;
+	context->out << "//   byteWidth = " << rasterRecord.byteWidth << endl;
+	context->out << "//   colorSpace = " << endl;
+	ReportColorSpaceInfo(rasterRecord.colorSpace);
+	context->out << "//   bitsPerPixel = " << rasterRecord.bitsPerPixel << endl;
+	context->out << "//   originalColorSpace = " << endl;
+
+	// If originalColorSpace = -1, then raster hasn't been through the color converter
+	if (rasterRecord.originalColorSpace == -1)
+	{
+		context->out << "(hasn't been converted yet)";
+	}
+	else
+	{
+		ReportColorSpaceInfo(rasterRecord.originalColorSpace);
+	}
+}
+
+void Canvas::ReportColorSpaceInfo(short colorSpace)
+{
+	// Simple way to describe color space types for debugging purposes
+	static const char *colorSpaces[] =
+	{
+		"kGrayColorSpace", "kRGBColorSpace", "kCMYKColorSpace"
+	};
+
+	// Color space info
+	context->out << std::string(colorSpaces[colorSpace]) << " (" << colorSpace << ")";
+
+	// Alpha?
+	if (colorSpace & kColorSpaceHasAlpha)
+	{
+		context->out << " with alpha";
+	}
+}
+
+void Canvas::RenderPluginArt(AIArtHandle artHandle, unsigned int depth)
+{
+	(void)depth;
+
+	// For Illustrator plug-in art types, like "Compound Shape" and "Blend" 
+	// For simplicity, we render the "Result Group" (instead of the "Edit Group", which contains all of the original art)
+	// The result group itself is rendered by the traversal (see GetChildren)
+
+	// What kind of plug-in art is this?
+	// TODO: Do we really need to allocate memory here? Or does the call do it for us?
+	char **pluginArtName = (char **)calloc(1024, sizeof(char));
+	sAIPluginGroup->GetPluginArtName(artHandle, pluginArtName);
+	if (context->debug)
+	{
+		context->out << "// Plug-in art name = " << std::string(*pluginArtName) << endl;
+	}
+
+	// Is this the Pathfinder Suite? If so, we need to grab the style from this art handle
+	if (strcmp(*pluginArtName, "Pathfinder Suite") == 0)
+	{
+		// Set pathfinder style
+		pathfinderStyle = documentResources->artInfo.GetStyle(artHandle);
+		usePathfinderStyle = true;
+
+		// Determine if this plug-in art is clipping
+		AIBoolean clipping = false;
+		sAIPluginGroup->GetPluginArtClipping(artHandle, &clipping);
+
+		// Set clip on our "special style" so we know to clip later
+		pathfinderStyle.clip = clipping;
+	}
 
 	// Release memory
 	free(pluginArtName);
@@ -1037,9 +1298,9 @@ void Canvas::RenderSymbolArt(AIArtHandle artHandle, unsigned int depth)
 	sAIRealMath->AIRealMatrixConcat(&transform, &currentState->internalTransform, &transform);
 
 	// Render symbol transformation
-	outFile << contextName << ".transform(";
-	RenderTransform(transform);
-	outFile << ");" << endl;
+	context->out << contextName << ".transform(";
+	RenderTransform(context->out, transform);
+	context->out << ");" << endl;
 
 	// Get the symbol pattern
 	AIPatternHandle symbolPatternHandle = NULL;
@@ -1053,7 +1314,7 @@ void Canvas::RenderSymbolArt(AIArtHandle artHandle, unsigned int depth)
 	if (symbolPattern)
 	{
 		// Call the symbol function
-		outFile << symbolPattern->name << "(" << contextName << ");" << endl;
+		context->out << symbolPattern->name << "(" << contextName << ");" << endl;
 	}
 
 	// Restore canvas state
@@ -1061,20 +1322,20 @@ void Canvas::RenderSymbolArt(AIArtHandle artHandle, unsigned int depth)
 	SetContextDrawingState(depth);
 }
 
+// Begins a compound path (its sub-paths are rendered by the traversal, see GetChildren)
 void Canvas::RenderCompoundPathArt(AIArtHandle artHandle, unsigned int depth)
 {
-	// Get the first art element in the group
-	AIArtHandle childArtHandle = NULL;
-	sAIArt->GetArtFirstChild(artHandle, &childArtHandle);
-
-	outFile << contextName << ".beginPath();" << endl;
+	(void)artHandle;
+	(void)depth;
 
-	// Render this sub-group
-	RenderArt(childArtHandle, depth);
+	context->out << contextName << ".beginPath();" << endl;
+}
 
+// Styles a compound path after its sub-paths have been rendered
+void Canvas::FinishCompoundPathArt(AIArtHandle artHandle, unsigned int depth)
+{
 	// Get the "normal" style for this path
-	AIPathStyle style;
-	sAIPathStyle->GetPathStyle(artHandle, &style);
+	const AIPathStyle& style = documentResources->artInfo.GetStyle(artHandle);
 
 	// Apply style
 	RenderPathStyle(style, depth);
@@ -1085,13 +1346,11 @@ void Canvas::RenderCompoundPathArt(AIArtHandle artHandle, unsigned int depth)
 
 void Canvas::RenderPathArt(AIArtHandle artHandle, unsigned int depth)
 {
-	if (debug)
+	if (context->debug)
 	{
-		ai::UnicodeString artName;
-		AIBoolean isDefaultName = false;
-		sAIArt->GetArtName(artHandle, artName, &isDefaultName);
-		outFile << "// art name: " << artName.as_UTF8() << endl;
-		cout << "// art name: " << artName.as_UTF8() << endl;
+		const std::string& artName = documentResources->artInfo.GetUTF8Name(artHandle);
+		context->out << "// art name: " << artName << endl;
+		cout << "// art name: " << artName << endl;
 	}
 
 	// Skip if this path is a "guide"
@@ -1100,23 +1359,19 @@ void Canvas::RenderPathArt(AIArtHandle artHandle, unsigned int depth)
 	if (!isGuide)
 	{
 		// Is this art part of a compound path?
-		AIBoolean isCompound = false;
-		ai::int32 attr = 0;
-		sAIArt->GetArtUserAttr(artHandle, kArtPartOfCompound, &attr);
-		isCompound = ((attr &kArtPartOfCompound) == kArtPartOfCompound);
-		if (debug)
+		AIBoolean isCompound = documentResources->artInfo.IsPartOfCompound(artHandle);
+		if (context->debug)
 		{
-			outFile << "// Art is compound = " << isCompound << endl;
+			context->out << "// Art is compound = " << isCompound << endl;
 		}
 
 		// Get the "normal" style for this path
-		AIPathStyle style;
-		sAIPathStyle->GetPathStyle(artHandle, &style);
+		const AIPathStyle& style = documentResources->artInfo.GetStyle(artHandle);
 
 		// Begin path
 		if (!isCompound)
 		{
-			outFile << contextName << ".beginPath();" << endl;
+			context->out << contextName << ".beginPath();" << endl;
 		}
 
 		// Write each path as a figure
@@ -1157,14 +1412,14 @@ void Canvas::RenderPathFigure(AIArtHandle artHandle)
 	// Remember the first segment, in case we have to create an extra segment to close the figure
 	AIPathSegment firstSegment = segment;
 
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// raw: (" << segment.p.h << ", " << segment.p.v << ")" << endl;
+		context->out << "// raw: (" << segment.p.h << ", " << segment.p.v << ")" << endl;
 		cout << "// raw: (" << segment.p.h << ", " << segment.p.v << ")" << endl;
 
 		AIRealPoint p;
 		sAIHardSoft->AIRealPointHarden(&segment.p, &p);
-		outFile << "// hard: (" << p.h << ", " << p.v << ")" << endl;
+		context->out << "// hard: (" << p.h << ", " << p.v << ")" << endl;
 		cout << "// hard: (" << p.h << ", " << p.v << ")" << endl;
 
 	}
@@ -1175,7 +1430,7 @@ void Canvas::RenderPathFigure(AIArtHandle artHandle)
 	TransformPoint(segment.out);
 
 	// Move to the first point
-	outFile << contextName << ".moveTo(" <<
+	context->out << contextName << ".moveTo(" <<
 		setiosflags(ios::fixed) << setprecision(1) <<
 		segment.p.h << ", " << segment.p.v << ");" << endl;
 
@@ -1203,15 +1458,15 @@ void Canvas::RenderPathFigure(AIArtHandle artHandle)
 		RenderSegment(previousSegment, firstSegment);
 
 		// Close the path
-		outFile << contextName << ".closePath();" << endl;
+		context->out << contextName << ".closePath();" << endl;
 	}
 }
 
 void Canvas::RenderSegment(AIPathSegment& previousSegment, AIPathSegment& segment)
 {
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// raw: (" << segment.p.h << ", " << segment.p.v << ")" << endl;
+		context->out << "// raw: (" << segment.p.h << ", " << segment.p.v << ")" << endl;
 	}
 
 	// Transform points
@@ -1229,14 +1484,14 @@ void Canvas::RenderSegment(AIPathSegment& previousSegment, AIPathSegment& segmen
 	if (isLine)
 	{
 		// Draw straight line
-		outFile << contextName << ".lineTo(" <<
+		context->out << contextName << ".lineTo(" <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			segment.p.h << ", " << segment.p.v << ");" << endl;
 	}
 	else
 	{
 		// Output Bezier segment
-		outFile << contextName << ".bezierCurveTo(" <<
+		context->out << contextName << ".bezierCurveTo(" <<
 			setiosflags(ios::fixed) << setprecision(1)
 			<< previousSegment.out.h << ", " << previousSegment.out.v << ", "
 			<< segment.in.h << ", " << segment.in.v << ", "
@@ -1249,18 +1504,18 @@ void Canvas::RenderPathStyle(const AIPathStyle& style, unsigned int depth)
 	// Is this clipping?
 	if (style.clip)
 	{
-		outFile << contextName << ".clip();" << endl;
+		context->out << contextName << ".clip();" << endl;
 	}
 	else if (renderMode == RM_HitTest)
 	{
-		outFile << "if (" << contextName << ".isPointInPath(x, y, ";
+		context->out << "if (" << contextName << ".isPointInPath(x, y, ";
 
 		if (style.evenodd)
 		{
-			outFile << "'evenodd'" << endl;
+			context->out << "'evenodd'" << endl;
 		}
 
-		outFile << "))" << endl << indent << "return true; " << endl << undent;
+		context->out << "))" << endl << indent << "return true; " << endl << undent;
 	}
 	else
 	{
@@ -1273,12 +1528,12 @@ void Canvas::RenderPathStyle(const AIPathStyle& style, unsigned int depth)
 			RenderFillInfo(style.fill.color, depth);
 			if (style.evenodd)
 			{
-				outFile << contextName << ".fill(\"evenodd\");" << endl;
+				context->out << contextName << ".fill(\"evenodd\");" << endl;
 			}
 			else
 			{
 				// Non-zero is the default, so no need to specify
-				outFile << contextName << ".fill();" << endl;
+				context->out << contextName << ".fill();" << endl;
 			}
 		}
 
@@ -1286,7 +1541,7 @@ void Canvas::RenderPathStyle(const AIPathStyle& style, unsigned int depth)
 		if (style.strokePaint)
 		{
 			RenderStrokeInfo(style.stroke);
-			outFile << contextName << ".stroke();" << endl;
+			context->out << contextName << ".stroke();" << endl;
 		}
 	}
 }
@@ -1296,9 +1551,9 @@ void Canvas::RenderPlacedArt(AIArtHandle artHandle, unsigned int depth)
 	// Get type of placed art
 	short placedType = 0;
 	sAIPlaced->GetPlacedType(artHandle, &placedType);
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Placed art type = " << placedType << endl;
+		context->out << "// Placed art type = " << placedType << endl;
 	}
 
 	// Only bother if this isn't EPS art (should then be linked raster art)
@@ -1307,9 +1562,9 @@ void Canvas::RenderPlacedArt(AIArtHandle artHandle, unsigned int depth)
 		// Get file path
 		ai::UnicodeString path;
 		sAIPlaced->GetPlacedFilePathFromArt(artHandle, path);
-		if (debug)
+		if (context->debug)
 		{
-			outFile << "// Placed art file path = " << path.as_Platform() << endl;
+			context->out << "// Placed art file path = " << path.as_Platform() << endl;
 		}
 
 		// Add a new image
@@ -1319,10 +1574,7 @@ void Canvas::RenderPlacedArt(AIArtHandle artHandle, unsigned int depth)
 		image->pathIsAbsolute = true;
 
 		// Get image "alt" name
-		ai::UnicodeString artName;
-		AIBoolean isDefaultName = false;
-		sAIArt->GetArtName(artHandle, artName, &isDefaultName);
-		std::string cleanName = artName.as_Platform();
+		std::string cleanName = documentResources->artInfo.GetName(artHandle).as_Platform();
 		CleanFunction(cleanName);
 		CleanString(cleanName, false);
 		image->name = cleanName;
@@ -1336,8 +1588,7 @@ void Canvas::RenderPlacedArt(AIArtHandle artHandle, unsigned int depth)
 		sAIPlaced->GetPlacedDimensions(artHandle, &size, &viewBounds, &viewMatrix, &imageBounds, &imageMatrix);
 
 		// Get the art bounding box (which includes transformations)
-		AIRealRect bounds;
-		sAIArt->GetArtBounds(artHandle, &bounds);
+		AIRealRect bounds = documentResources->artInfo.GetBounds(artHandle);
 
 		// Transform the art bounding box
 		TransformRect(bounds);
@@ -1371,9 +1622,9 @@ void Canvas::RenderPlacedArt(AIArtHandle artHandle, unsigned int depth)
 		SetContextDrawingState(depth);
 
 		// Render transform
-		outFile << contextName << ".transform(";
-		RenderTransform(transform);
-		outFile << ");" << endl;
+		context->out << contextName << ".transform(";
+		RenderTransform(context->out, transform);
+		context->out << ");" << endl;
 
 		// Get actual image dimensions (files that aren't 72 DPI don't report real sizes, so need to do this)
 		AIRasterRecord info;
@@ -1390,7 +1641,7 @@ void Canvas::RenderPlacedArt(AIArtHandle artHandle, unsigned int depth)
 	}
 }
 
-void Canvas::RenderRasterArt(AIArtHandle artHandle)
+void Canvas::RenderRasterArt(AIArtHandle artHandle, unsigned int depth)
 {
 	// Get the raster record
 	AIRasterRecord rasterRecord;
@@ -1400,63 +1651,253 @@ void Canvas::RenderRasterArt(AIArtHandle artHandle)
 	// TODO: Is this *always* present? NO, it isn't. Need to add a base filename for empty paths.
 	ai::UnicodeString path;
 	sAIRaster->GetRasterFilePathFromArt(artHandle, path);
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Raster file path from art = " << path.as_Platform() << endl;
+		context->out << "// Raster file path from art = " << path.as_Platform() << endl;
 	}
 
-	// Did we get a filename?
-	std::string fileName = path.as_UTF8();
-	if (fileName.length() > 0)
-	{
-		// Construct a FilePath
-		ai::UnicodeString usFileName(fileName);
-		ai::FilePath aiFilePath(usFileName);
+	// Size of the raster in its own pixels
+	AIReal rasterWidth = rasterRecord.bounds.right - rasterRecord.bounds.left;
+	AIReal rasterHeight = rasterRecord.bounds.bottom - rasterRecord.bounds.top;
 
-		// Extract file name
-		fileName = aiFilePath.GetFileNameNoExt().as_Platform();
+	// NOTE: Remember that a single image/filename can be embedded multiple times using different
+	//       transformations in a single Illustrator document. We rasterize each source once (untransformed),
+	//       and let the canvas apply the raster matrix for every placement.
+	std::string sourceKey;
+	std::string sourcePath = path.as_UTF8();
+	SPPlatformFileInfo fileInfo;
+	uint64_t fileSize = 0;
+	if (sourcePath.length() > 0 &&
+		IsRasterFileUnchanged(artHandle) &&
+		GetFileSize(path.as_Platform(), fileSize))
+	{
+		AIErr result = sAIRaster->GetRasterFileInfoFromArt(artHandle, &fileInfo);
+		if (!result)
+		{
+			// Same file (path, size and modification time), same pixel grid and same pixel format means the same source
+			// NOTE: Rasters without a file, or whose file has changed since they were embedded, can't be matched
+			//       (their pixels may not be the file's), so those are rasterized per placement
+			std::ostringstream key;
+			key << sourcePath << "|" << fileSize << "|" << GetModificationTime(fileInfo) << "|" <<
+				rasterWidth << "x" << rasterHeight << "|" << rasterRecord.colorSpace << "|" << rasterRecord.bitsPerPixel;
+			sourceKey = key.str();
+		}
 	}
-	else
+
+	// Have we already rasterized this source?
+	Image* image = sourceKey.empty() ? NULL : documentResources->images.FindSource(sourceKey);
+	AIBoolean isNative = (image != NULL);
+	if (!image)
 	{
-		// Create a base filename
-		fileName = "image";
-	}
+		// Did we get a filename?
+		std::string fileName = sourcePath;
+		std::string extension = "";
+		if (fileName.length() > 0)
+		{
+			// Construct a FilePath
+			ai::UnicodeString usFileName(fileName);
+			ai::FilePath aiFilePath(usFileName);
+
+			// Extract file name and extension
+			fileName = aiFilePath.GetFileNameNoExt().as_Platform();
+			extension = aiFilePath.GetFileExtension().as_Platform();
+			ToLower(extension);
+		}
+		else
+		{
+			// Create a base filename
+			fileName = "image";
+		}
 
-	// Get a unique file name
-	std::string uniqueFileName = GetUniqueFileName(documentResources->folderPath, fileName, ".png");
+		// Is the source a JPEG photo that the browser can decode as-is?
+		unsigned int jpgWidth = 0;
+		unsigned int jpgHeight = 0;
+		unsigned int jpgComponents = 0;
+		unsigned int jpgOrientation = 1;
+		AIBoolean isPassthrough = false;
+		if ((extension == "jpg" || extension == "jpeg") &&
+			FileExists(path.as_Platform()) &&
+			IsRasterFileUnchanged(artHandle) &&
+			GetJPGDimensions(path.as_Platform(), jpgWidth, jpgHeight, jpgComponents, jpgOrientation))
+		{
+			// Only pass through grayscale/RGB files (browsers don't convert CMYK JPEGs reliably) that
+			// hold exactly the embedded pixels (not cropped or resampled), in their stored orientation
+			// (browsers don't agree on whether the EXIF orientation applies to canvas drawing)
+			isPassthrough = (jpgComponents == 1 || jpgComponents == 3) &&
+				(jpgWidth == (unsigned int)(rasterWidth + 0.5f)) &&
+				(jpgHeight == (unsigned int)(rasterHeight + 0.5f)) &&
+				(jpgOrientation == 1);
+		}
 
-	// Full path to file
-	std::string fullPath = documentResources->folderPath + uniqueFileName;
+		// Write to a temporary file first, since the final name depends on the content
+		std::string tempPath = documentResources->folderPath + GetTempAssetName(".jpg");
 
-	// NOTE: Remember that a single image/filename can be embedded multiple times using different
-	//       transformations in a single Illustrator document. So, they need to be unique when they're rasterized anyway.
-	RasterizeArtToPNG(artHandle, fullPath);
+		// Can we copy the original bytes?
+		if (isPassthrough)
+		{
+			// No re-encoding, so no loss and a much smaller file than a PNG
+			isPassthrough = CopyBinaryFile(path.as_Platform(), tempPath);
+			isNative = isPassthrough;
+			if (context->debug)
+			{
+				context->out << "// Copied original JPEG file, width = " << jpgWidth << ", height = " << jpgHeight << endl;
+			}
+		}
 
-	// Add a new image
-	Image* image = documentResources->images.Add(uniqueFileName);
+		// Do we need to rasterize?
+		if (!isPassthrough)
+		{
+			// Rasterize to a PNG file
+			tempPath = documentResources->folderPath + GetTempAssetName(".png");
 
-	// Image is NOT an absolute path
-	image->pathIsAbsolute = false;
+			// Rasterize the source at its native resolution
+			isNative = RasterizeRasterSourceToPNG(artHandle, tempPath);
+			if (!isNative)
+			{
+				// Couldn't isolate the source, so rasterize the art as placed
+				RasterizeArtToPNG(artHandle, tempPath, 1.0f);
+			}
+		}
 
-	// Get image "alt" name
-	ai::UnicodeString artName;
-	AIBoolean isDefaultName = false;
-	sAIArt->GetArtName(artHandle, artName, &isDefaultName);
-	std::string cleanName = artName.as_Platform();
-	CleanFunction(cleanName);
-	CleanString(cleanName, false);
-	image->name = cleanName;
+		// Name the file after its content
+		std::string contentFileName = NameFileByContent(documentResources->folderPath, tempPath, fileName, isPassthrough ? ".jpg" : ".png");
+
+		// Full path to file
+		std::string fullPath = documentResources->folderPath + contentFileName;
+
+		// Add a new image (or find the image with identical content)
+		image = documentResources->images.Add(contentFileName);
+
+		// Image is NOT an absolute path
+		image->pathIsAbsolute = false;
+
+		// Remember the source, so other placements can reuse this file
+		if (isNative)
+		{
+			documentResources->images.SetSource(image, sourceKey);
+		}
+
+		// Get the actual dimensions of the image file
+		if (isPassthrough)
+		{
+			// The scale from JPEG pixels to raster pixels takes care of the file DPI
+			image->width = jpgWidth;
+			image->height = jpgHeight;
+		}
+		else
+		{
+			GetPNGDimensions(fullPath, image->width, image->height);
+		}
+		if (context->debug)
+		{
+			context->out << "// Actual image file dimensions, width = " << image->width << ", height = " << image->height << endl;
+		}
+
+		// Art rasterized as placed is only sharp at 1x, so add higher density variants
+		if (!isNative && image->variants.empty())
+		{
+			RasterizeArtVariants(artHandle, image, fileName);
+		}
+
+		// Get image "alt" name
+		std::string cleanName = documentResources->artInfo.GetName(artHandle).as_Platform();
+		CleanFunction(cleanName);
+		CleanString(cleanName, false);
+		image->name = cleanName;
+	}
 
 	// Get the art bounding box (which includes transformations)
-	AIRealRect bounds;
-	sAIArt->GetArtBounds(artHandle, &bounds);
+	AIRealRect bounds = documentResources->artInfo.GetBounds(artHandle);
 
 	// Transform the art bounding box
 	TransformRect(bounds);
-
-	// Draw image
-	image->RenderDrawImage(contextName, bounds.left, bounds.top);
 	image->DebugBounds(contextName, bounds);
+
+	// Was the source rasterized without its placement transformation?
+	if (isNative)
+	{
+		// The rasterizer doesn't always produce exactly one PNG pixel per raster pixel, so scale back to the raster pixel grid
+		AIRealMatrix transform;
+		sAIRealMath->AIRealMatrixSetIdentity(&transform);
+		if (image->width > 0 && image->height > 0)
+		{
+			sAIRealMath->AIRealMatrixConcatScale(&transform, rasterWidth / image->width, rasterHeight / image->height);
+		}
+
+		// Raster pixels to artwork coordinates
+		AIRealMatrix rasterMatrix;
+		sAIRaster->GetRasterMatrix(artHandle, &rasterMatrix);
+		sAIRealMath->AIRealMatrixConcat(&transform, &rasterMatrix, &transform);
+
+		// Artwork to canvas coordinates
+		if (currentState->isProcessingSymbol)
+		{
+			// Symbols are defined in their own coordinate space
+			sAIHardSoft->AIRealMatrixHarden(&transform);
+		}
+		else
+		{
+			sAIRealMath->AIRealMatrixConcat(&transform, &currentState->internalTransform, &transform);
+		}
+
+		// Save canvas state, so we can temporarily transform
+		depth++;
+		SetContextDrawingState(depth);
+
+		// Render transform
+		context->out << contextName << ".transform(";
+		RenderTransform(context->out, transform);
+		context->out << ");" << endl;
+
+		// Draw image at the origin of the raster
+		image->RenderDrawImage(contextName, 0.0f, 0.0f);
+
+		// Restore canvas state
+		depth--;
+		SetContextDrawingState(depth);
+	}
+	else
+	{
+		// Draw image (it was rasterized as placed)
+		image->RenderDrawImage(contextName, bounds.left, bounds.top);
+	}
+}
+
+// Rasterizes the source pixels of raster art, without its placement transformation
+// Returns false if the source couldn't be isolated (or rasterized)
+AIBoolean Canvas::RasterizeRasterSourceToPNG(AIArtHandle artHandle, const std::string& path)
+{
+	// A copy in a symbol or pattern definition would update every instance, so those are rasterized as placed
+	if (isDefinition)
+	{
+		return false;
+	}
+
+	// Work on a temporary copy (placed above the original, and disposed of when we're done), so the original keeps its matrix
+	AIArtHandle sourceArtHandle = NULL;
+	AIErr result = sAIArt->DuplicateArt(artHandle, kPlaceAbove, artHandle, &sourceArtHandle);
+
+	// Did we get a copy?
+	if (result || !sourceArtHandle)
+	{
+		return false;
+	}
+	documentResources->hasTemporaryArt = true;
+
+	// One point per pixel, flipped because raster pixel rows go down while artwork coordinates go up
+	AIRealMatrix nativeMatrix =
+	{
+		1, 0, 0, -1, 0, 0
+	};
+	sAIRaster->SetRasterMatrix(sourceArtHandle, &nativeMatrix);
+
+	// Rasterize the untransformed copy
+	result = RasterizeArtToPNG(sourceArtHandle, path, 1.0f);
+
+	// Remove the copy
+	sAIArt->DisposeArt(sourceArtHandle);
+
+	return (result == kNoErr);
 }
 
 // 10/11/2012: Added alpha support
@@ -1471,24 +1912,12 @@ void Canvas::RenderMidPointColor(const AIColor& color1, AIReal alpha1, const AIC
 	// Calculate mid-point
 	AIReal percentage = 0.5;
 
-	// Output color values
-	if (alpha1 != 1.0f ||
-		alpha2 != 1.0f)
-	{
-		// Include alpha
-		outFile << "rgba(" <<
-			(int)((rgbColor1.c.rgb.red + (percentage *(rgbColor2.c.rgb.red - rgbColor1.c.rgb.red)))*(float)255) << ", " <<
-			(int)((rgbColor1.c.rgb.green + (percentage *(rgbColor2.c.rgb.green - rgbColor1.c.rgb.green)))*(float)255) << ", " <<
-			(int)((rgbColor1.c.rgb.blue + (percentage *(rgbColor2.c.rgb.blue - rgbColor1.c.rgb.blue)))*(float)255) << ", " <<
-			setiosflags(ios::fixed) << setprecision(2) << (alpha1 + (percentage * (alpha2 - alpha1))) << ")";
-	}
-	else
-	{
-		outFile << "rgb(" <<
-			(int)((rgbColor1.c.rgb.red + (percentage *(rgbColor2.c.rgb.red - rgbColor1.c.rgb.red)))*(float)255) << ", " <<
-			(int)((rgbColor1.c.rgb.green + (percentage *(rgbColor2.c.rgb.green - rgbColor1.c.rgb.green)))*(float)255) << ", " <<
-			(int)((rgbColor1.c.rgb.blue + (percentage *(rgbColor2.c.rgb.blue - rgbColor1.c.rgb.blue)))*(float)255) << ")";
-	}
+	// Output color value
+	context->out << documentResources->styles.Color(documentResources->colors.GetColorString(
+		ToColorComponent(rgbColor1.c.rgb.red + (percentage * (rgbColor2.c.rgb.red - rgbColor1.c.rgb.red))),
+		ToColorComponent(rgbColor1.c.rgb.green + (percentage * (rgbColor2.c.rgb.green - rgbColor1.c.rgb.green))),
+		ToColorComponent(rgbColor1.c.rgb.blue + (percentage * (rgbColor2.c.rgb.blue - rgbColor1.c.rgb.blue))),
+		alpha1 + (percentage * (alpha2 - alpha1))));
 }
 
 void Canvas::RenderGradient(const AIGradientStyle& gradientStyle, unsigned int depth)
@@ -1559,7 +1988,7 @@ void Canvas::RenderGradient(const AIGradientStyle& gradientStyle, unsigned int d
 			sAIHardSoft->AIRealPointHarden(&p2, &p2);
 		}
 
-		outFile << "gradient = " << contextName << ".createLinearGradient(" <<
+		context->out << context->gradientName << " = " << contextName << ".createLinearGradient(" <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			p1.h << ", " << p1.v << ", " << p2.h << ", " << p2.v << ");" << endl;
 
@@ -1607,13 +2036,13 @@ void Canvas::RenderGradient(const AIGradientStyle& gradientStyle, unsigned int d
 		sAIRealMath->AIRealMatrixConcatTranslate(&transform, p1.h, p1.v);
 
 		// Set gradient transform
-		outFile << contextName << ".transform(";
-		RenderTransform(transform);
-		outFile << ");" << endl;
+		context->out << contextName << ".transform(";
+		RenderTransform(context->out, transform);
+		context->out << ");" << endl;
 
 		// HACK: We subtract 0.1 to work around a bug in Chrome/the spec
 		// https://bugs.chromium.org/p/chromium/issues/detail?id=322487
-		outFile << "gradient = " << contextName << ".createRadialGradient(" <<
+		context->out << context->gradientName << " = " << contextName << ".createRadialGradient(" <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			gradientStyle.hiliteLength * std::max(0.0, gradientStyle.gradientLength - 0.1) << ", " << 0 << ", " << 0 << ", "
 			<< 0 << ", " << 0 << ", " << gradientStyle.gradientLength << ");" << endl;
@@ -1640,20 +2069,20 @@ void Canvas::RenderGradientStops(const AIGradientStyle& gradientStyle)
 	{
 		sAIGradient->GetNthGradientStop(gradientStyle.gradient, index, &gradientStop);
 		stopPoint = gradientStop.rampPoint / (float)100;
-		outFile << "gradient.addColorStop(" <<
+		context->out << context->gradientName << ".addColorStop(" <<
 			setiosflags(ios::fixed) << setprecision(2) <<
-			stopPoint << ", " << GetColor(gradientStop.color, gradientStop.opacity) << ");" << endl;
+			stopPoint << ", " << documentResources->styles.Color(GetColor(gradientStop.color, gradientStop.opacity)) << ");" << endl;
 
 		// Handle midpoints that aren't exacly at 50% (ignore midpoint for last stop)
 		if (gradientStop.midPoint != 50.0f && index < (count - 1))
 		{
 			sAIGradient->GetNthGradientStop(gradientStyle.gradient, index + 1, &gradientStopNext);
 			stopPoint = (gradientStop.rampPoint + ((gradientStop.midPoint / (float)100)*(gradientStopNext.rampPoint - gradientStop.rampPoint))) / (float)100;
-			outFile << "gradient.addColorStop(" <<
+			context->out << context->gradientName << ".addColorStop(" <<
 				setiosflags(ios::fixed) << setprecision(2) <<
-				stopPoint << ", \"";
+				stopPoint << ", ";
 			RenderMidPointColor(gradientStop.color, gradientStop.opacity, gradientStopNext.color, gradientStopNext.opacity);
-			outFile << "\");" << endl;
+			context->out << ");" << endl;
 		}
 	}
 }
@@ -1661,8 +2090,8 @@ void Canvas::RenderGradientStops(const AIGradientStyle& gradientStyle)
 // Output fill information
 void Canvas::RenderFillInfo(const AIColor& fillColor, unsigned int depth)
 {
-	// Allocate memory for fill style value string
-	std::string fillStyle;
+	// Interned fill style value
+	unsigned int fillStyle = StringTable::kEmptyString;
 
 	// Get fill style value
 	GetFillStyle(fillColor, 1.0f, fillStyle);
@@ -1682,7 +2111,7 @@ void Canvas::RenderFillInfo(const AIColor& fillColor, unsigned int depth)
 			currentState->fillStyle = fillStyle;
 
 			// Change the fill style
-			outFile << contextName << ".fillStyle = " << currentState->fillStyle << ";" << endl;
+			context->out << contextName << ".fillStyle = " << documentResources->styles.Color(documentResources->strings.Get(currentState->fillStyle)) << ";" << endl;
 		}
 		break;
 	}
@@ -1704,18 +2133,18 @@ void Canvas::RenderFillInfo(const AIColor& fillColor, unsigned int depth)
 
 			// Create the pattern
 			// Don't save context, since this is a different/sub canvas
-			outFile << "pattern = " << contextName << ".createPattern(" <<
+			context->out << context->patternName << " = " << contextName << ".createPattern(" <<
 				"document.getElementById(\"pattern" << pattern->canvasIndex << "\"), \"repeat\");" << endl;
 
 			// Set pattern fill transform
 			// TODO: Need to figure out how to determine proper X and Y offsets
 			// TODO: We should be able to avoid this, if the transform is identity
-			outFile << contextName << ".transform(";
-			RenderTransform(fillColor.c.p.transform);
-			outFile << ");" << endl;
+			context->out << contextName << ".transform(";
+			RenderTransform(context->out, fillColor.c.p.transform);
+			context->out << ");" << endl;
 
 			// Change fill style to pattern
-			outFile << contextName << ".fillStyle = " << currentState->fillStyle << ";" << endl;
+			context->out << contextName << ".fillStyle = " << documentResources->strings.Get(currentState->fillStyle) << ";" << endl;
 		}
 
 		break;
@@ -1736,12 +2165,12 @@ void Canvas::RenderFillInfo(const AIColor& fillColor, unsigned int depth)
 		// Set gradient fill transform
 		// TODO: Need to figure out how to determine proper X and Y offsets
 		// TODO: We should be able to avoid this, if the transform is identity
-		//outFile << "%s%s.transform(", Indent(depth), m_currentCanvas->contextName.c_str()) << endl;
-		//RenderTransform(fillColor.c.b.matrix);
-		//outFile << ");");
+		//context->out << "%s%s.transform(", Indent(depth), m_currentCanvas->contextName.c_str()) << endl;
+		//RenderTransform(context->out, fillColor.c.b.matrix);
+		//context->out << ");");
 
 		// Change the fill style
-		outFile << contextName << ".fillStyle = " << currentState->fillStyle << ";" << endl;
+		context->out << contextName << ".fillStyle = " << documentResources->strings.Get(currentState->fillStyle) << ";" << endl;
 		break;
 	}
 	case kNoneColor:
@@ -1751,9 +2180,8 @@ void Canvas::RenderFillInfo(const AIColor& fillColor, unsigned int depth)
 	}
 }
 
-// Returns a fill style string
-// NOTE: Should allocate enough memory for a worst-case result ("rgba(000, 000, 000, 1.00)" + '\0') = 28 bytes
-void Canvas::GetFillStyle(const AIColor& color, AIReal alpha, std::string& fillStyle)
+// Returns an interned fill style string
+void Canvas::GetFillStyle(const AIColor& color, AIReal alpha, unsigned int& fillStyle)
 {
 	// Based on kind of color
 	switch (color.kind)
@@ -1764,19 +2192,19 @@ void Canvas::GetFillStyle(const AIColor& color, AIReal alpha, std::string& fillS
 	case kThreeColor:
 	{
 		// Get the fill color value
-		fillStyle = GetColor(color, alpha);
+		fillStyle = documentResources->strings.Intern(GetColor(color, alpha));
 		break;
 	}
 	case kPattern:
 	{
-		// Return "pattern"
-		fillStyle = "pattern";
+		// The pattern local
+		fillStyle = documentResources->strings.Intern(context->patternName);
 		break;
 	}
 	case kGradient:
 	{
-		// Return "gradient"
-		fillStyle = "gradient";
+		// The gradient local
+		fillStyle = documentResources->strings.Intern(context->gradientName);
 		break;
 	}
 	case kNoneColor:
@@ -1789,34 +2217,34 @@ void Canvas::GetFillStyle(const AIColor& color, AIReal alpha, std::string& fillS
 // Report on a pattern style
 void Canvas::ReportPatternStyleInfo(const AIPatternStyle& patternStyle)
 {
-	outFile << "// Pattern Info" << endl;
-	outFile << "//   shiftDist = " <<
+	context->out << "// Pattern Info" << endl;
+	context->out << "//   shiftDist = " <<
 		setiosflags(ios::fixed) << setprecision(1) <<
 		patternStyle.shiftDist << endl;
-	outFile << "//   shiftAngle = %.2f" <<
+	context->out << "//   shiftAngle = %.2f" <<
 		setiosflags(ios::fixed) << setprecision(2) <<
 		patternStyle.shiftAngle << endl;
-	outFile << "//   scale = " <<
+	context->out << "//   scale = " <<
 		setiosflags(ios::fixed) << setprecision(1) <<
 		patternStyle.scale.h << ", " << patternStyle.scale.v << endl;
-	outFile << "//   rotate = " <<
+	context->out << "//   rotate = " <<
 		setiosflags(ios::fixed) << setprecision(2) <<
 		patternStyle.rotate << endl;
-	outFile << "//   reflect = " << patternStyle.reflect << endl;
-	outFile << "//   reflectAngle = " <<
+	context->out << "//   reflect = " << patternStyle.reflect << endl;
+	context->out << "//   reflectAngle = " <<
 		setiosflags(ios::fixed) << setprecision(2) <<
 		patternStyle.reflectAngle << endl;
-	outFile << "//   shearAngle = " <<
+	context->out << "//   shearAngle = " <<
 		setiosflags(ios::fixed) << setprecision(2) <<
 		patternStyle.shearAngle << endl;
-	outFile << "//   shiftDist = " <<
+	context->out << "//   shiftDist = " <<
 		setiosflags(ios::fixed) << setprecision(1) <<
 		patternStyle.shiftDist << endl;
-	outFile << "//   shiftAxis = " <<
+	context->out << "//   shiftAxis = " <<
 		setiosflags(ios::fixed) << setprecision(1) <<
 		patternStyle.shearAxis << endl;
-	outFile << "//   transform = " << endl;
-	RenderTransform(patternStyle.transform);
+	context->out << "//   transform = " << endl;
+	RenderTransform(context->out, patternStyle.transform);
 }
 
 // Output stroke information
@@ -1827,7 +2255,7 @@ void Canvas::RenderStrokeInfo(const AIStrokeStyle& strokeStyle)
 	if (strokeStyle.dash.length != 0)
 	{
 		// Stroke uses a dash style that has no canvas equivalent
-		outFile << "// This artwork uses an unsupported dash style" << endl;
+		context->out << "// This artwork uses an unsupported dash style" << endl;
 	}
 
 	// Stroke thickness
@@ -1837,9 +2265,7 @@ void Canvas::RenderStrokeInfo(const AIStrokeStyle& strokeStyle)
 		currentState->lineWidth = strokeStyle.width;
 
 		// Output line width change
-		outFile << contextName << ".lineWidth = " <<
-			setiosflags(ios::fixed) << setprecision(1) <<
-			currentState->lineWidth << ";" << endl;
+		context->out << contextName << ".lineWidth = " << documentResources->styles.LineWidth(currentState->lineWidth) << ";" << endl;
 	}
 
 	// Stroke color
@@ -1850,11 +2276,8 @@ void Canvas::RenderStrokeInfo(const AIStrokeStyle& strokeStyle)
 	case kCustomColor:
 	case kThreeColor:
 	{
-		// Allocate memory for stroke style value string
-		std::string strokeStyleValue;
-
-		// Get the stroke color value
-		strokeStyleValue = GetColor(strokeStyle.color, 1.0f);
+		// Get the interned stroke color value
+		unsigned int strokeStyleValue = documentResources->strings.Intern(GetColor(strokeStyle.color, 1.0f));
 
 		// Is the stroke color different?
 		if (strokeStyleValue != currentState->strokeStyle)
@@ -1863,7 +2286,7 @@ void Canvas::RenderStrokeInfo(const AIStrokeStyle& strokeStyle)
 			currentState->strokeStyle = strokeStyleValue;
 
 			// Change the stroke style
-			outFile << contextName << ".strokeStyle = " << currentState->strokeStyle << ";" << endl;
+			context->out << contextName << ".strokeStyle = " << documentResources->styles.Color(documentResources->strings.Get(currentState->strokeStyle)) << ";" << endl;
 		}
 		break;
 	}
@@ -1887,19 +2310,19 @@ void Canvas::RenderStrokeInfo(const AIStrokeStyle& strokeStyle)
 		case (kAIButtCap):
 		{
 			// Butt line caps
-			outFile << contextName << ".lineCap = \"butt\";" << endl;
+			context->out << contextName << ".lineCap = \"butt\";" << endl;
 			break;
 		}
 		case (kAIRoundCap):
 		{
 			// Round line caps
-			outFile << contextName << ".lineCap = \"round\";" << endl;
+			context->out << contextName << ".lineCap = \"round\";" << endl;
 			break;
 		}
 		case (kAIProjectingCap):
 		{
 			// Projecting/square line caps 
-			outFile << contextName << ".lineCap = \"square\";" << endl;
+			context->out << contextName << ".lineCap = \"square\";" << endl;
 			break;
 		}
 		}
@@ -1919,13 +2342,13 @@ void Canvas::RenderStrokeInfo(const AIStrokeStyle& strokeStyle)
 		case (kAIMiterJoin):
 		{
 			// Miter line joins (the default join type)
-			outFile << contextName << ".lineJoin = \"miter\";" << endl;
+			context->out << contextName << ".lineJoin = \"miter\";" << endl;
 
 			// Accomodate the miter limit (see NOTES to understand why this won't work) - set to "1" for now, which is basically the same as "Bevel"
 			// Although we don't include "Miter", since it's the default, we do need this hack ("10" is the canvas default)
 			// TODO: Report miter bug to IE9 team (Safari, Chrome, and Firefox work fine)
 			AIReal miterLimit = strokeStyle.miterLimit;
-			outFile << contextName << ".miterLimit = " <<
+			context->out << contextName << ".miterLimit = " <<
 				setiosflags(ios::fixed) << setprecision(1) <<
 				miterLimit << ";" << endl;
 
@@ -1937,13 +2360,13 @@ void Canvas::RenderStrokeInfo(const AIStrokeStyle& strokeStyle)
 		case (kAIRoundJoin):
 		{
 			// Round line joins
-			outFile << contextName << ".lineJoin = \"round\";" << endl;
+			context->out << contextName << ".lineJoin = \"round\";" << endl;
 			break;
 		}
 		case (kAIBevelJoin):
 		{
 			// Bevel line joins
-			outFile << contextName << ".lineJoin = \"bevel\";" << endl;
+			context->out << contextName << ".lineJoin = \"bevel\";" << endl;
 			break;
 		}
 		}
@@ -1967,6 +2390,22 @@ void Canvas::RenderGlyphRuns(AIArtHandle textFrameArt, unsigned int depth)
 	AIRealMatrix textFrameMatrix;
 	textFrameMatrix = frame.GetMatrix();
 
+	// Are we drawing the text with glyph outlines? (falls back to fillText if the outlines can't be matched to the glyphs)
+	// Text in symbol and pattern definitions is always drawn with fillText, since its outlines would update every instance
+	AIArtHandle outlineArt = NULL;
+	size_t outlineIndex = 0;
+	if (textOutlines && !isDefinition)
+	{
+		outlineArt = CreateGlyphOutlines(textFrameArt, frame);
+	}
+
+	// Character features of the last glyph run, so unchanged runs don't have to be queried again
+	ATE::ICharFeatures lastFeatures;
+	bool hasFeatures = false;
+
+	// State/style information for the current glyph run (style values carry over while features are unchanged)
+	GlyphState glyphState;
+
 	// Get the text lines
 	ATE::ITextLinesIterator lines = frame.GetTextLinesIterator();
 	while (lines.IsNotDone())
@@ -1974,9 +2413,9 @@ void Canvas::RenderGlyphRuns(AIArtHandle textFrameArt, unsigned int depth)
 		ATE::ITextLine line = lines.Item();
 		ATE::IGlyphRunsIterator glyphRuns = line.GetGlyphRunsIterator();
 
-		// Text for a set of glyph runs
-		char *text = (char *)malloc(1);
-		*text = '\0';
+		// Text for a set of glyph runs (and a high surrogate the last run ended with)
+		glyphText.clear();
+		ATETextDOM::Unicode pendingSurrogate = 0;
 
 		// Do we need to grab an origin?
 		// TODO: Seems messy...can we clean this logic up?
@@ -1991,67 +2430,70 @@ void Canvas::RenderGlyphRuns(AIArtHandle textFrameArt, unsigned int depth)
 			// Get next glyph run
 			ATE::IGlyphRun glyphRun = glyphRuns.Item();
 
-			// Initialize state/style information for this run
-			GlyphState glyphState;
-			ASInt32 count = 0;
-			char *contents = NULL;
-
 			// Any contents?
-			count = glyphRun.GetCharacterCount();
+			ASInt32 count = glyphRun.GetCharacterCount();
 			if (count > 0)
 			{
 				// Get text contents of glyph run
-				contents = (char *)calloc(count + 1, sizeof(char));
-				glyphRun.GetContents(contents, count);
-
-				// Get the state/style information for this glyph run
-				// TODO: Remember to clear the memory from this instance
-				GetGlyphState(glyphRun, glyphState, textFrameMatrix);
-
-				// We don't want to output every glyph run individually, so see if anything has changed that will force us to render
-				// TODO: We need a better way to handle this!
-				if (!GlyphStatesMatch(lastGlyphState, glyphState) && !grabOrigin)
+				if (glyphContents.size() < (size_t)count + 1)
 				{
-					// Output
-					RenderGlyphRun(text, lastGlyphState, depth);
+					glyphContents.resize(count + 1);
+				}
+				ASInt32 length = glyphRun.GetContents(&glyphContents[0], count + 1);
 
-					// Since we've rendered this text, clear it
-					text = (char *)realloc(text, 1);
-					*text = '\0';
+				// Only derive the style information if the character features have changed
+				ATE::ICharFeatures features = glyphRun.GetCharFeatures();
+				if (!hasFeatures || !features.IsEqual(lastFeatures))
+				{
+					GetGlyphState(features, glyphState);
 
-					// Also need to capture a new origin
-					grabOrigin = true;
+					// Remember features
+					lastFeatures = features;
+					hasFeatures = true;
 				}
 
-				// Add current contents
-				size_t length = strlen(text) + strlen(contents) + 1;
-				text = (char *)realloc(text, length);
-#ifdef MAC_ENV
-				strcat(text, contents);
-#endif
-#ifdef WIN_ENV
-				strcat_s(text, length, contents);
-#endif
-
-				// Remember last state
-				// TODO: Do strings copy okay here?
-				AIReal oldTx = lastGlyphState.glyphMatrix.tx;
-				AIReal oldTy = lastGlyphState.glyphMatrix.ty;
-				lastGlyphState = glyphState;
+				// Every run has its own position
+				GetGlyphMatrix(glyphRun.GetMatrix(), glyphRun.GetOrigins().Item(0), glyphState, textFrameMatrix, glyphState.glyphMatrix);
 
-				// Carry forward the initial origin, but only if we don't need to capture the origin (where we initially capture it)
-				if (!grabOrigin)
+				// Outlines are drawn run by run
+				if (outlineArt)
 				{
-					lastGlyphState.glyphMatrix.tx = oldTx;
-					lastGlyphState.glyphMatrix.ty = oldTy;
+					RenderGlyphOutlines(glyphRun, glyphState, textFrameMatrix, (size_t)(length < count ? length : count), outlineIndex, depth);
 				}
+				else
+				{
+					// We don't want to output every glyph run individually, so see if anything has changed that will force us to render
+					// TODO: We need a better way to handle this!
+					if (!GlyphStatesMatch(lastGlyphState, glyphState) && !grabOrigin)
+					{
+						// Output
+						RenderGlyphRun(glyphText, lastGlyphState, depth);
+
+						// Since we've rendered this text, clear it
+						glyphText.clear();
+
+						// Also need to capture a new origin
+						grabOrigin = true;
+					}
 
-				// No longer the first pass
-				grabOrigin = false;
+					// Add current contents
+					AppendEscapedText(glyphText, &glyphContents[0], (size_t)(length < count ? length : count), pendingSurrogate);
 
-				// Release memory
-				free(contents);
-				contents = NULL;
+					// Remember last state
+					AIReal oldTx = lastGlyphState.glyphMatrix.tx;
+					AIReal oldTy = lastGlyphState.glyphMatrix.ty;
+					lastGlyphState = glyphState;
+
+					// Carry forward the initial origin, but only if we don't need to capture the origin (where we initially capture it)
+					if (!grabOrigin)
+					{
+						lastGlyphState.glyphMatrix.tx = oldTx;
+						lastGlyphState.glyphMatrix.ty = oldTy;
+					}
+
+					// No longer the first pass
+					grabOrigin = false;
+				}
 			}
 
 			// Get the next glyph run
@@ -2059,109 +2501,135 @@ void Canvas::RenderGlyphRuns(AIArtHandle textFrameArt, unsigned int depth)
 		}
 
 		// Do we have any text yet to render?
-		if (strlen(text) > 0)
+		FinishEscapedText(glyphText, pendingSurrogate);
+		if (!glyphText.empty())
 		{
 			// Render it
-			RenderGlyphRun(text, lastGlyphState, depth);
+			RenderGlyphRun(glyphText, lastGlyphState, depth);
 		}
 
-		// Release memory
-		free(text);
-		text = NULL;
-
 		// Get the next line
 		lines.Next();
 	}
+
+	// Close the last transform group
+	EndTextGroup(depth);
+
+	// Remove the temporary outlines
+	if (outlineArt)
+	{
+		sAIArt->DisposeArt(outlineArt);
+	}
 }
 
 // Output the actual glyph run
-void Canvas::RenderGlyphRun(char *contents, const GlyphState& glyphState, unsigned int depth)
+// Transformed runs that share a transformation (apart from translation) and a style are drawn in one transform group
+void Canvas::RenderGlyphRun(const std::string& text, const GlyphState& glyphState, unsigned int depth)
 {
-	// Have any font attributes changed?
-	if (glyphState.fontSize != currentState->fontSize ||
-		glyphState.fontName != currentState->fontName ||
-		glyphState.fontStyleName != currentState->fontStyleName)
-	{
-		// Output font and style information
-		outFile << contextName << ".font = \"";
-		if (glyphState.fontStyleName != "Regular")
-		{
-			outFile << glyphState.fontStyleName << " ";
-		}
-		outFile << setiosflags(ios::fixed) << setprecision(1) << glyphState.fontSize << "px '" << glyphState.fontName << "'\";" << endl;
+	// Has the text been transformed?
+	AIBoolean isTransformed = (glyphState.glyphMatrix.a != 1.0f || glyphState.glyphMatrix.b != 0.0f || glyphState.glyphMatrix.c != 0.0f || glyphState.glyphMatrix.d != 1.0f);
 
-		// Remember current font state
-		currentState->fontSize = glyphState.fontSize;
-		currentState->fontName = glyphState.fontName;
-		currentState->fontStyleName = glyphState.fontStyleName;
+	// Can we stay in the current transform group?
+	if (textGroupOpen && !(isTransformed && GlyphStatesMatch(textGroupState, glyphState)))
+	{
+		EndTextGroup(depth);
 	}
 
-	// Has the text been transformed?
-	AIBoolean isTransformed = (glyphState.glyphMatrix.a != 1.0f || glyphState.glyphMatrix.b != 0.0f || glyphState.glyphMatrix.c != 0.0f || glyphState.glyphMatrix.d != 1.0f);
-	if (isTransformed)
+	if (textGroupOpen)
 	{
-		// Save canvas state, so we can temporarily transform
-		depth++;
-		SetContextDrawingState(depth);
-
-		// Render transform
-		outFile << contextName << ".transform(";
-		RenderTransform(glyphState.glyphMatrix);
-		outFile << ");" << endl;
+		// Position within the group's transformation
+		AIRealPoint offset = { glyphState.glyphMatrix.tx, glyphState.glyphMatrix.ty };
+		sAIRealMath->AIRealMatrixXformPoint(&textGroupInverse, &offset, &offset);
+		RenderGlyphText(text, glyphState, offset.h, offset.v);
 	}
-
-	// Fill the text?
-	if (glyphState.textFilled)
+	else
 	{
-		// Fill color...
-		RenderFillInfo(glyphState.fillColor, depth);
+		// Have any font attributes changed?
+		if (glyphState.fontSize != currentState->fontSize ||
+			glyphState.fontName != currentState->fontName ||
+			glyphState.fontStyleName != currentState->fontStyleName)
+		{
+			// Output font and style information
+			const std::string& font = documentResources->fonts.GetCSSFont(glyphState.fontName, glyphState.fontStyleName, glyphState.fontSize);
+			context->out << contextName << ".font = " << documentResources->styles.Font(font) << ";" << endl;
+
+			// Remember current font state
+			currentState->fontSize = glyphState.fontSize;
+			currentState->fontName = glyphState.fontName;
+			currentState->fontStyleName = glyphState.fontStyleName;
+		}
 
-		// Output text
 		if (isTransformed)
 		{
-			// Allow transformation to position text
-			outFile << contextName << ".fillText(\"" << contents << "\", " <<
-				setiosflags(ios::fixed) << setprecision(1) <<
-				0 << ", " << 0 << ");" << endl;
+			// Save canvas state, so we can temporarily transform
+			depth++;
+			SetContextDrawingState(depth);
+
+			// Render transform
+			context->out << contextName << ".transform(";
+			RenderTransform(context->out, glyphState.glyphMatrix);
+			context->out << ");" << endl;
+
+			// Following runs are positioned within this transformation
+			textGroupOpen = true;
+			textGroupState = glyphState;
+			textGroupInverse = glyphState.glyphMatrix;
+			sAIRealMath->AIRealMatrixInvert(&textGroupInverse);
 		}
-		else
+
+		// Fill color...
+		if (glyphState.textFilled)
 		{
-			// Since there's no transformation, simply output text at correct point
-			outFile << contextName << ".fillText(\"" << contents << "\", " <<
-				setiosflags(ios::fixed) << setprecision(1) <<
-				glyphState.glyphMatrix.tx << ", " << glyphState.glyphMatrix.ty << ");" << endl;
+			RenderFillInfo(glyphState.fillColor, depth);
 		}
-	}
 
-	// Stroke the text?
-	if (glyphState.textStroked)
-	{
-		// Render stroke information
-		RenderStrokeInfo(glyphState.strokeStyleValue);
+		// Stroke information
+		if (glyphState.textStroked)
+		{
+			RenderStrokeInfo(glyphState.strokeStyleValue);
+		}
 
-		// Output text
 		if (isTransformed)
 		{
 			// Allow transformation to position text
-			outFile << contextName << ".strokeText(\"" << contents << "\", " <<
-				setiosflags(ios::fixed) << setprecision(1) <<
-				0 << ", " << 0 << ");" << endl;
+			RenderGlyphText(text, glyphState, 0.0f, 0.0f);
 		}
 		else
 		{
 			// Since there's no transformation, simply output text at correct point
-			outFile << contextName << ".strokeText(\"" << contents << "\", " <<
-				setiosflags(ios::fixed) << setprecision(1) <<
-				glyphState.glyphMatrix.tx << ", " << glyphState.glyphMatrix.ty << ");" << endl;
+			RenderGlyphText(text, glyphState, glyphState.glyphMatrix.tx, glyphState.glyphMatrix.ty);
 		}
 	}
+}
 
-	// If we transformed...
-	if (isTransformed)
+// Output fillText/strokeText calls for a glyph run (the font and colors have already been set)
+void Canvas::RenderGlyphText(const std::string& text, const GlyphState& glyphState, AIReal x, AIReal y)
+{
+	// Fill the text?
+	if (glyphState.textFilled)
+	{
+		context->out << contextName << ".fillText(\"" << text << "\", " <<
+			setiosflags(ios::fixed) << setprecision(1) <<
+			x << ", " << y << ");" << endl;
+	}
+
+	// Stroke the text?
+	if (glyphState.textStroked)
+	{
+		context->out << contextName << ".strokeText(\"" << text << "\", " <<
+			setiosflags(ios::fixed) << setprecision(1) <<
+			x << ", " << y << ");" << endl;
+	}
+}
+
+// Close the current transform group of glyph runs (if there is one)
+void Canvas::EndTextGroup(unsigned int depth)
+{
+	if (textGroupOpen)
 	{
 		// Restore the state (mostly to return to prior transformation)
-		depth--;
 		SetContextDrawingState(depth);
+		textGroupOpen = false;
 	}
 }
 
@@ -2191,12 +2659,9 @@ AIBoolean Canvas::GlyphStatesMatch(const GlyphState& state1, const GlyphState& s
 		);
 }
 
-// Gets all of the important state information for a glyph run
-void Canvas::GetGlyphState(const ATE::IGlyphRun& glyphRun, GlyphState& glyphState, const AIRealMatrix& textFrameMatrix)
+// Gets all of the important style information for a glyph run from its character features
+void Canvas::GetGlyphState(const ATE::ICharFeatures& features, GlyphState& glyphState)
 {
-	// Get character features
-	ATE::ICharFeatures features = glyphRun.GetCharFeatures();
-
 	// To test for local feature assignments
 	bool isAssigned = false;
 
@@ -2205,42 +2670,44 @@ void Canvas::GetGlyphState(const ATE::IGlyphRun& glyphRun, GlyphState& glyphStat
 	glyphState.fontSize = features.GetFontSize(&isAssigned);
 
 	// Get font info
+	glyphState.fontName = StringTable::kEmptyString;			// In case the font isn't assigned
+	glyphState.fontStyleName = StringTable::kEmptyString;
 	ATE::IFont font = features.GetFont(&isAssigned);
 	if (isAssigned)
 	{
-		// Allocate memory for font names and styles
-		char *systemFontName = (char*)calloc(1024, sizeof(char));
-		char *fontStyleName = (char*)calloc(1024, sizeof(char));
-
 		// Local font is assigned
 		FontRef fontRef = font.GetRef();
-		AIFontKey fontKey = NULL;
-		sAIFont->FontKeyFromFont(fontRef, &fontKey);
 
-		// Get system font name
-		// TODO: Note that this may be Windows-specific...need to figure out the Apple equivalent
-		sAIFont->GetSystemFontName(fontKey, systemFontName, 1024);
-		if (debug)
+		// Have we already looked up this font?
+		if (!documentResources->fonts.Find(fontRef, glyphState.fontName, glyphState.fontStyleName))
 		{
-			outFile << "// Font system name: " << systemFontName << endl;
+			// Buffers for font names and styles
+			char systemFontName[1024] = "";
+			char fontStyleName[1024] = "";
+
+			AIFontKey fontKey = NULL;
+			sAIFont->FontKeyFromFont(fontRef, &fontKey);
+
+			// Get system font name
+			// TODO: Note that this may be Windows-specific...need to figure out the Apple equivalent
+			sAIFont->GetSystemFontName(fontKey, systemFontName, 1024);
+
+			// Determine font variant
+			sAIFont->GetFontStyleName(fontKey, fontStyleName, 1024);
+
+			// Copy to glyph state
+			glyphState.fontName = documentResources->strings.Intern(systemFontName);
+			glyphState.fontStyleName = documentResources->strings.Intern(fontStyleName);
+
+			// Remember them
+			documentResources->fonts.Add(fontRef, glyphState.fontName, glyphState.fontStyleName);
 		}
 
-		// Determine font variant
-		sAIFont->GetFontStyleName(fontKey, fontStyleName, 1024);
-		if (debug)
+		if (context->debug)
 		{
-			outFile << "// Font style name: " << fontStyleName << endl;
+			context->out << "// Font system name: " << documentResources->strings.Get(glyphState.fontName) << endl;
+			context->out << "// Font style name: " << documentResources->strings.Get(glyphState.fontStyleName) << endl;
 		}
-
-		// Copy to glyph state
-		glyphState.fontName = std::string(systemFontName);
-		glyphState.fontStyleName = std::string(fontStyleName);
-
-		// Release memory
-		free(systemFontName);
-		systemFontName = NULL;
-		free(fontStyleName);
-		fontStyleName = NULL;
 	}
 
 	// Is there a vertical scale?
@@ -2259,45 +2726,8 @@ void Canvas::GetGlyphState(const ATE::IGlyphRun& glyphRun, GlyphState& glyphStat
 		glyphState.horizontalScale = 1.0f;
 	}
 
-	// Get the matrix for this glyph run
-	glyphState.glyphMatrix = glyphRun.GetMatrix();
-
-	// Get character origin points array
-	// Since we only use the first origin, no need to check array size
-	// NOTE: Only use the first origin, since canvas doesn't support advanced character spacing (like Illustrator),
-	//       and we choose to be programmable over being pixel-accurate. This behavior could easily be modified, however.
-	ATE::IArrayRealPoint glyphOrigins = glyphRun.GetOrigins();
-
-	// Glyph origin
-	AIRealPoint glyphOrigin;
-
-	// Get first origin offset for this glyph (no need to pull for each character)
-	glyphOrigin = glyphOrigins.Item(0);
-
-	// Apply scaling
-	sAIRealMath->AIRealMatrixConcatScale(&glyphState.glyphMatrix, glyphState.horizontalScale, glyphState.verticalScale);
-
-	// Concat by [1 0 0 -1 0 0] as text coordinates are going positive the other direction.
-	AIRealMatrix flipY =
-	{
-		1, 0, 0,  -1, 0, 0
-	};
-	sAIRealMath->AIRealMatrixConcat(&flipY, &glyphState.glyphMatrix, &glyphState.glyphMatrix);
-
-	// Translate the origin
-	sAIRealMath->AIRealMatrixConcatTranslate(&glyphState.glyphMatrix, glyphOrigin.h, glyphOrigin.v);
-
-	// Concatenate glyph matrix with text frame matrix
-	sAIRealMath->AIRealMatrixConcat(&glyphState.glyphMatrix, &textFrameMatrix, &glyphState.glyphMatrix);
-
-	// ATE space is application independent, and doesn't know about this Illustrator soft/hard coordinate thingy, so take care of it here
-	sAIHardSoft->AIRealMatrixRealSoft(&glyphState.glyphMatrix);
-
-	// Modify with our internal transform
-	sAIRealMath->AIRealMatrixConcat(&glyphState.glyphMatrix, &currentState->internalTransform, &glyphState.glyphMatrix);
-
 	// Is the text filled?
-	glyphState.fillStyle = "";		// In case we don't have a fill style
+	glyphState.fillStyle = StringTable::kEmptyString;		// In case we don't have a fill style
 	glyphState.textFilled = false;
 	AIBoolean hasFill = features.GetFill(&isAssigned);
 	if (isAssigned && hasFill)
@@ -2312,13 +2742,13 @@ void Canvas::GetGlyphState(const ATE::IGlyphRun& glyphRun, GlyphState& glyphStat
 			// Get as AIColor
 			sATEPaint->GetAIColor(ATEfillColor.GetRef(), &glyphState.fillColor);
 
-			// Allocate memory for fill style value string
+			// Get interned fill style value
 			GetFillStyle(glyphState.fillColor, 1.0f, glyphState.fillStyle);
 		}
 	}
 
 	// Is the text stroked?
-	glyphState.strokeStyle = "";		// In case we don't have a stroke style
+	glyphState.strokeStyle = StringTable::kEmptyString;		// In case we don't have a stroke style
 	glyphState.textStroked = false;
 	AIBoolean hasStroke = features.GetStroke(&isAssigned);
 	if (isAssigned && hasStroke)
@@ -2363,58 +2793,408 @@ void Canvas::GetGlyphState(const ATE::IGlyphRun& glyphRun, GlyphState& glyphStat
 	}
 }
 
+// Gets the transformation of a glyph at an origin within its run (uses the scaling already in the glyph state)
+// NOTE: Text runs only use the first origin, since canvas doesn't support advanced character spacing (like Illustrator),
+//       and we choose to be programmable over being pixel-accurate. Glyph outlines use every origin.
+void Canvas::GetGlyphMatrix(const AIRealMatrix& runMatrix, const AIRealPoint& glyphOrigin, const GlyphState& glyphState, const AIRealMatrix& textFrameMatrix, AIRealMatrix& glyphMatrix)
+{
+	// Start with the matrix for the glyph run
+	glyphMatrix = runMatrix;
+
+	// Apply scaling
+	sAIRealMath->AIRealMatrixConcatScale(&glyphMatrix, glyphState.horizontalScale, glyphState.verticalScale);
+
+	// Concat by [1 0 0 -1 0 0] as text coordinates are going positive the other direction.
+	AIRealMatrix flipY =
+	{
+		1, 0, 0,  -1, 0, 0
+	};
+	sAIRealMath->AIRealMatrixConcat(&flipY, &glyphMatrix, &glyphMatrix);
+
+	// Translate the origin
+	sAIRealMath->AIRealMatrixConcatTranslate(&glyphMatrix, glyphOrigin.h, glyphOrigin.v);
+
+	// Concatenate glyph matrix with text frame matrix
+	sAIRealMath->AIRealMatrixConcat(&glyphMatrix, &textFrameMatrix, &glyphMatrix);
+
+	// ATE space is application independent, and doesn't know about this Illustrator soft/hard coordinate thingy, so take care of it here
+	sAIHardSoft->AIRealMatrixRealSoft(&glyphMatrix);
+
+	// Modify with our internal transform
+	sAIRealMath->AIRealMatrixConcat(&glyphMatrix, &currentState->internalTransform, &glyphMatrix);
+}
+
+// Creates temporary outlines of a text frame, and collects one outline per inked glyph
+// Returns NULL if the outlines can't be matched to the glyphs (e.g. because of ligatures), so the text falls back to fillText
+AIArtHandle Canvas::CreateGlyphOutlines(AIArtHandle textFrameArt, const ATE::ITextFrame& frame)
+{
+	// Let Illustrator outline the text (the outlines are placed in the document, so they have to be disposed)
+	AIArtHandle outlineArt = NULL;
+	AIErr result = sAITextFrame->CreateOutline(textFrameArt, &outlineArt);
+	if (result || !outlineArt)
+	{
+		outlineArt = NULL;
+	}
+	else
+	{
+		documentResources->hasTemporaryArt = true;
+
+		// Collect the glyph outlines (in text order)
+		glyphOutlines.clear();
+		AddGlyphOutlines(outlineArt);
+
+		// Count the glyphs that should have an outline
+		AIBoolean matches = true;
+		size_t inkedCount = 0;
+		ATE::ITextLinesIterator lines = frame.GetTextLinesIterator();
+		while (matches && lines.IsNotDone())
+		{
+			ATE::IGlyphRunsIterator glyphRuns = lines.Item().GetGlyphRunsIterator();
+			while (matches && glyphRuns.IsNotDone())
+			{
+				ATE::IGlyphRun glyphRun = glyphRuns.Item();
+				ASInt32 count = glyphRun.GetCharacterCount();
+				if (count > 0)
+				{
+					// Get text contents of glyph run
+					if (glyphContents.size() < (size_t)count + 1)
+					{
+						glyphContents.resize(count + 1);
+					}
+					ASInt32 length = glyphRun.GetContents(&glyphContents[0], count + 1);
+
+					// We can only tell which glyphs are blank if there's one glyph per character
+					if (glyphRun.GetGlyphIDs().GetSize() != length)
+					{
+						matches = false;
+					}
+					else
+					{
+						for (ASInt32 i = 0; i < length; i++)
+						{
+							if (!IsBlankCharacter(glyphContents[i]))
+							{
+								inkedCount++;
+							}
+						}
+					}
+				}
+				glyphRuns.Next();
+			}
+			lines.Next();
+		}
+
+		// Did we get an outline for each inked glyph?
+		if (!matches || inkedCount != glyphOutlines.size())
+		{
+			if (context->debug)
+			{
+				context->out << "// Glyph outlines don't match the text (" << glyphOutlines.size() << " outlines, " << inkedCount << " glyphs), using fillText" << endl;
+			}
+
+			sAIArt->DisposeArt(outlineArt);
+			outlineArt = NULL;
+		}
+	}
+
+	return outlineArt;
+}
+
+// Collects the glyph outlines within a group of outlines
+void Canvas::AddGlyphOutlines(AIArtHandle artHandle)
+{
+	// NOTE: The outlines are temporary, so their properties aren't remembered in the art info cache
+	AIArtHandle childArtHandle = NULL;
+	sAIArt->GetArtFirstChild(artHandle, &childArtHandle);
+	while (childArtHandle)
+	{
+		short type = kUnknownArt;
+		sAIArt->GetArtType(childArtHandle, &type);
+		switch (type)
+		{
+		case kGroupArt:
+		{
+			// Lines and runs may be grouped
+			AddGlyphOutlines(childArtHandle);
+			break;
+		}
+		case kPathArt:
+		case kCompoundPathArt:
+		{
+			// One glyph
+			glyphOutlines.push_back(childArtHandle);
+			break;
+		}
+		}
+
+		sAIArt->GetArtSibling(childArtHandle, &childArtHandle);
+	}
+}
+
+// Returns true if a character doesn't produce an outline (white space and control characters)
+AIBoolean Canvas::IsBlankCharacter(ATETextDOM::Unicode c)
+{
+	return (c <= 0x20 ||
+		c == 0x00A0 ||
+		c == 0x1680 ||
+		(c >= 0x2000 && c <= 0x200B) ||
+		c == 0x2028 ||
+		c == 0x2029 ||
+		c == 0x202F ||
+		c == 0x205F ||
+		c == 0x3000 ||
+		c == 0xFEFF);
+}
+
+// Draws a glyph run as references to cached glyph outlines (instead of fillText)
+void Canvas::RenderGlyphOutlines(const ATE::IGlyphRun& glyphRun, const GlyphState& glyphState, const AIRealMatrix& textFrameMatrix, size_t length, size_t& outlineIndex, unsigned int depth)
+{
+	// Is there anything to draw?
+	AIBoolean isVisible = (renderMode == RM_HitTest || glyphState.textFilled || glyphState.textStroked) && glyphState.fontSize > 0.0f;
+	if (isVisible)
+	{
+		// Save canvas state, so we can temporarily transform
+		depth++;
+		SetContextDrawingState(depth);
+
+		// Fill and stroke information
+		if (renderMode != RM_HitTest)
+		{
+			if (glyphState.textFilled)
+			{
+				RenderFillInfo(glyphState.fillColor, depth);
+			}
+			if (glyphState.textStroked)
+			{
+				RenderStrokeInfo(glyphState.strokeStyleValue);
+			}
+		}
+
+		// Glyph outlines are in font units, so scale by the font size
+		AIRealMatrix scaleMatrix;
+		sAIRealMath->AIRealMatrixSetScale(&scaleMatrix, glyphState.fontSize, glyphState.fontSize);
+		AIRealMatrix unitsMatrix;
+		sAIRealMath->AIRealMatrixConcat(&scaleMatrix, &glyphState.glyphMatrix, &unitsMatrix);
+		context->out << contextName << ".transform(";
+		RenderTransform(context->out, unitsMatrix);
+		context->out << ");" << endl;
+
+		// Keep the stroke width in points
+		if (renderMode != RM_HitTest && glyphState.textStroked)
+		{
+			currentState->lineWidth = glyphState.strokeStyleValue.width / glyphState.fontSize;
+			context->out << contextName << ".lineWidth = " << setiosflags(ios::fixed) << setprecision(4) << currentState->lineWidth << ";" << endl;
+		}
+	}
+
+	// To find glyph offsets within the run
+	AIRealMatrix inverseRunMatrix = glyphState.glyphMatrix;
+	sAIRealMath->AIRealMatrixInvert(&inverseRunMatrix);
+
+	// Where the drawing origin is (in font units, as written)
+	AIReal originH = 0.0f;
+	AIReal originV = 0.0f;
+
+	// Draw each inked glyph
+	AIRealMatrix runMatrix = glyphRun.GetMatrix();
+	ATE::IArrayRealPoint glyphOrigins = glyphRun.GetOrigins();
+	ATE::IArrayGlyphID glyphIDs = glyphRun.GetGlyphIDs();
+	for (size_t i = 0; i < length; i++)
+	{
+		// Blank glyphs don't have an outline
+		if (!IsBlankCharacter(glyphContents[i]))
+		{
+			AIArtHandle outlineArtHandle = glyphOutlines[outlineIndex++];
+			if (isVisible)
+			{
+				// Transformation of this glyph
+				AIRealMatrix glyphMatrix;
+				GetGlyphMatrix(runMatrix, glyphOrigins.Item((ASInt32)i), glyphState, textFrameMatrix, glyphMatrix);
+
+				// Have we already outlined this glyph?
+				unsigned int glyphID = (unsigned int)glyphIDs.Item((ASInt32)i);
+				const std::string* name = documentResources->glyphs.Find(glyphState.fontName, glyphState.fontStyleName, glyphID);
+				if (!name)
+				{
+					// Bring the outline back into font units
+					AIRealMatrix inverseGlyphMatrix = glyphMatrix;
+					sAIRealMath->AIRealMatrixInvert(&inverseGlyphMatrix);
+
+					std::ostringstream data;
+					data << setiosflags(ios::fixed) << setprecision(3);
+					GetGlyphPathData(outlineArtHandle, inverseGlyphMatrix, glyphState.fontSize, data);
+					name = &documentResources->glyphs.Add(glyphState.fontName, glyphState.fontStyleName, glyphID, data.str());
+				}
+
+				// Offset of this glyph within the run (in font units, rounded as written so errors don't accumulate)
+				AIRealPoint offset = { glyphMatrix.tx, glyphMatrix.ty };
+				sAIRealMath->AIRealMatrixXformPoint(&inverseRunMatrix, &offset, &offset);
+				AIReal offsetH = (AIReal)floor(offset.h / glyphState.fontSize * 1000.0f + 0.5f) / 1000.0f;
+				AIReal offsetV = (AIReal)floor(offset.v / glyphState.fontSize * 1000.0f + 0.5f) / 1000.0f;
+
+				// Move to the glyph
+				if (offsetH != originH || offsetV != originV)
+				{
+					context->out << contextName << ".translate(" << setiosflags(ios::fixed) << setprecision(3) <<
+						offsetH - originH << ", " << offsetV - originV << ");" << endl;
+					originH = offsetH;
+					originV = offsetV;
+				}
+
+				// Draw the glyph
+				if (renderMode == RM_HitTest)
+				{
+					context->out << "if (" << contextName << ".isPointInPath(" << *name << ", x, y)) return true;" << endl;
+				}
+				else
+				{
+					if (glyphState.textFilled)
+					{
+						context->out << contextName << ".fill(" << *name << ");" << endl;
+					}
+					if (glyphState.textStroked)
+					{
+						context->out << contextName << ".stroke(" << *name << ");" << endl;
+					}
+				}
+			}
+		}
+	}
+
+	// If we transformed...
+	if (isVisible)
+	{
+		// Restore the state (to return to prior transformation)
+		depth--;
+		SetContextDrawingState(depth);
+	}
+}
+
+// Writes the SVG path data of a glyph outline (in font units)
+void Canvas::GetGlyphPathData(AIArtHandle artHandle, const AIRealMatrix& inverseMatrix, AIReal fontSize, std::ostringstream& data)
+{
+	short type = kUnknownArt;
+	sAIArt->GetArtType(artHandle, &type);
+	if (type == kCompoundPathArt)
+	{
+		// Each path of the compound path is a figure
+		AIArtHandle childArtHandle = NULL;
+		sAIArt->GetArtFirstChild(artHandle, &childArtHandle);
+		while (childArtHandle)
+		{
+			GetGlyphPathData(childArtHandle, inverseMatrix, fontSize, data);
+			sAIArt->GetArtSibling(childArtHandle, &childArtHandle);
+		}
+	}
+	else if (type == kPathArt)
+	{
+		// Get the segments
+		short segmentCount = 0;
+		sAIPath->GetPathSegmentCount(artHandle, &segmentCount);
+		if (segmentCount > 0)
+		{
+			std::vector<AIPathSegment> segments(segmentCount);
+			sAIPath->GetPathSegments(artHandle, 0, segmentCount, &segments[0]);
+
+			// Bring each point into font units
+			for (short i = 0; i < segmentCount; i++)
+			{
+				AIRealPoint* points[3] = { &segments[i].p, &segments[i].in, &segments[i].out };
+				for (int j = 0; j < 3; j++)
+				{
+					TransformPoint(*points[j]);
+					sAIRealMath->AIRealMatrixXformPoint(&inverseMatrix, points[j], points[j]);
+					points[j]->h /= fontSize;
+					points[j]->v /= fontSize;
+				}
+			}
+
+			// Is this a closed path?
+			AIBoolean pathClosed = false;
+			sAIPath->GetPathClosed(artHandle, &pathClosed);
+
+			// Move to the first point, then add each segment (and a closing segment for closed paths)
+			data << "M" << segments[0].p.h << " " << segments[0].p.v;
+			short closingCount = pathClosed ? segmentCount + 1 : segmentCount;
+			for (short i = 1; i < closingCount; i++)
+			{
+				const AIPathSegment& previousSegment = segments[i - 1];
+				const AIPathSegment& segment = segments[i % segmentCount];
+
+				// Is this a straight line segment?
+				AIBoolean isLine = ((previousSegment.p.h == previousSegment.out.h && previousSegment.p.v == previousSegment.out.v) &&
+					(segment.p.h == segment.in.h && segment.p.v == segment.in.v));
+				if (isLine)
+				{
+					data << "L" << segment.p.h << " " << segment.p.v;
+				}
+				else
+				{
+					data << "C" << previousSegment.out.h << " " << previousSegment.out.v << " " <<
+						segment.in.h << " " << segment.in.v << " " <<
+						segment.p.h << " " << segment.p.v;
+				}
+			}
+			if (pathClosed)
+			{
+				data << "Z";
+			}
+		}
+	}
+}
+
 void Canvas::ReportGlyphRunInfo(const ATE::IGlyphRun& glyphRun)
 {
 	// Get distance to baseline
 	AIReal distanceToBaseline = glyphRun.GetDistanceToBaseline();
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Distance to baseline: " <<
+		context->out << "// Distance to baseline: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			distanceToBaseline << endl;
 	}
 
 	// Get ascent
 	AIReal ascent = glyphRun.GetAscent();
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Ascent: " <<
+		context->out << "// Ascent: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			ascent << endl;
 	}
 
 	// Get descent
 	AIReal descent = glyphRun.GetDescent();
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Descent: " <<
+		context->out << "// Descent: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			descent << endl;
 	}
 
 	// Get max cap height
 	AIReal maxCapHeight = glyphRun.GetMaxCapHeight();
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Max cap height: " <<
+		context->out << "// Max cap height: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			maxCapHeight << endl;
 	}
 
 	// Get min cap height
 	AIReal minCapHeight = glyphRun.GetMinCapHeight();
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Min cap height: " <<
+		context->out << "// Min cap height: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			minCapHeight << endl;
 	}
 
 	// Get tracking
 	AIReal tracking = glyphRun.GetTracking();
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Tracking: " <<
+		context->out << "// Tracking: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			tracking << endl;
 	}
@@ -2431,9 +3211,9 @@ void Canvas::ReportCharacterFeatures(const ATE::ICharFeatures& features)
 	{
 		horizontalScale = 0;
 	}
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Horizontal scale: " <<
+		context->out << "// Horizontal scale: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			horizontalScale << endl;
 	}
@@ -2444,9 +3224,9 @@ void Canvas::ReportCharacterFeatures(const ATE::ICharFeatures& features)
 	{
 		verticalScale = 0;
 	}
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Vertical scale: " <<
+		context->out << "// Vertical scale: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			verticalScale << endl;
 	}
@@ -2457,9 +3237,9 @@ void Canvas::ReportCharacterFeatures(const ATE::ICharFeatures& features)
 	{
 		leading = 0;
 	}
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Leading: " <<
+		context->out << "// Leading: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			leading << endl;
 	}
@@ -2470,9 +3250,9 @@ void Canvas::ReportCharacterFeatures(const ATE::ICharFeatures& features)
 	{
 		tracking = 0;
 	}
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Tracking: " <<
+		context->out << "// Tracking: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			tracking << endl;
 	}
@@ -2483,9 +3263,9 @@ void Canvas::ReportCharacterFeatures(const ATE::ICharFeatures& features)
 	{
 		baselineShift = 0;
 	}
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Baseline shift: " <<
+		context->out << "// Baseline shift: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			baselineShift << endl;
 	}
@@ -2496,9 +3276,9 @@ void Canvas::ReportCharacterFeatures(const ATE::ICharFeatures& features)
 	{
 		characterRotation = 0;
 	}
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Character rotation: " <<
+		context->out << "// Character rotation: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			characterRotation << endl;
 	}
@@ -2509,129 +3289,122 @@ void Canvas::ReportCharacterFeatures(const ATE::ICharFeatures& features)
 	{
 		underlineOffset = 0;
 	}
-	if (debug)
+	if (context->debug)
 	{
-		outFile << "// Underline offset: " <<
+		context->out << "// Underline offset: " <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			underlineOffset << endl;
 	}
 }
 
-// Returns a color value string
-// NOTE: Should allocate enough memory for a worst-case result ("rgba(000, 000, 000, 1.00)" + '\0') = 28 bytes
-std::string Canvas::GetColor(const AIColor& color, AIReal alpha)
+// Returns a color value string (in the shortest CSS form, including double quotes)
+const std::string& Canvas::GetColor(const AIColor& color, AIReal alpha)
 {
 	// Convert to RGB color space
 	AIColor rgbColor;
 	ConvertColorToRGB(color, rgbColor);
 
-	// Stream for color string
-	std::ostringstream colorValue;
-
-	// Output color values
-	if (alpha != 1.0f)
-	{
-		// Include alpha
-		colorValue << "\"rgba(" << (int)(rgbColor.c.rgb.red * 255.0f) <<
-			", " << (int)(rgbColor.c.rgb.green * 255.0f) <<
-			", " << (int)(rgbColor.c.rgb.blue * 255.0f) <<
-			", " << setiosflags(ios::fixed) << setprecision(2) << alpha <<
-			")\"";
-	}
-	else
-	{
-		colorValue << "\"rgb(" << (int)(rgbColor.c.rgb.red * 255.0f) <<
-			", " << (int)(rgbColor.c.rgb.green * 255.0f) <<
-			", " << (int)(rgbColor.c.rgb.blue * 255.0f) <<
-			")\"";
-	}
+	// Look up (or format) the color string
+	return documentResources->colors.GetColorString(ToColorComponent(rgbColor.c.rgb.red),
+		ToColorComponent(rgbColor.c.rgb.green), ToColorComponent(rgbColor.c.rgb.blue), alpha);
+}
 
-	// Return the color string
-	return colorValue.str();
+// Converts a 0.0-1.0 color component to 0-255
+int Canvas::ToColorComponent(AIReal value)
+{
+	return std::max(0, std::min(255, (int)(value * 255.0f)));
 }
 
+// Converts a color to RGB (converting each distinct color only once per export)
 void Canvas::ConvertColorToRGB(const AIColor& sourceColor, AIColor& rbgColor)
 {
-	long srcSpace = 0;
-	long dstSpace = kAIRGBColorSpace;
-	SampleComponent srcColor[5];
-	SampleComponent dstColor[5];
-	ASBoolean inGamut;
-	AICustomColor customColor;
-
-	switch (sourceColor.kind)
-	{
-	case kGrayColor:
-	{
-		srcSpace = kAIGrayColorSpace;
-		srcColor[0] = (SampleComponent)(1.0f - sourceColor.c.g.gray); // !!!! Why do I have to invert? Seems wrong !!!!
-		break;
-	}
-	case kFourColor:
-	{
-		srcSpace = kAICMYKColorSpace;
-		srcColor[0] = (SampleComponent)sourceColor.c.f.cyan;
-		srcColor[1] = (SampleComponent)sourceColor.c.f.magenta;
-		srcColor[2] = (SampleComponent)sourceColor.c.f.yellow;
-		srcColor[3] = (SampleComponent)sourceColor.c.f.black;
-		break;
-	}
-	case (kCustomColor):
+	// Have we converted this color before?
+	if (!documentResources->colors.FindRGB(sourceColor, rbgColor))
 	{
-		sAICustomColor->GetCustomColor(sourceColor.c.c.color, &customColor);
+		long srcSpace = 0;
+		long dstSpace = kAIRGBColorSpace;
+		SampleComponent srcColor[5];
+		SampleComponent dstColor[5];
+		ASBoolean inGamut;
+		AICustomColor customColor;
 
-		// Convert custom color (why'd they make this different!?)
-		switch (customColor.kind)
+		switch (sourceColor.kind)
 		{
-		case kCustomFourColor:
+		case kGrayColor:
+		{
+			srcSpace = kAIGrayColorSpace;
+			srcColor[0] = (SampleComponent)(1.0f - sourceColor.c.g.gray); // !!!! Why do I have to invert? Seems wrong !!!!
+			break;
+		}
+		case kFourColor:
 		{
 			srcSpace = kAICMYKColorSpace;
-			srcColor[0] = (SampleComponent)customColor.c.f.cyan;
-			srcColor[1] = (SampleComponent)customColor.c.f.magenta;
-			srcColor[2] = (SampleComponent)customColor.c.f.yellow;
-			srcColor[3] = (SampleComponent)customColor.c.f.black;
+			srcColor[0] = (SampleComponent)sourceColor.c.f.cyan;
+			srcColor[1] = (SampleComponent)sourceColor.c.f.magenta;
+			srcColor[2] = (SampleComponent)sourceColor.c.f.yellow;
+			srcColor[3] = (SampleComponent)sourceColor.c.f.black;
+			break;
+		}
+		case (kCustomColor):
+		{
+			sAICustomColor->GetCustomColor(sourceColor.c.c.color, &customColor);
+
+			// Convert custom color (why'd they make this different!?)
+			switch (customColor.kind)
+			{
+			case kCustomFourColor:
+			{
+				srcSpace = kAICMYKColorSpace;
+				srcColor[0] = (SampleComponent)customColor.c.f.cyan;
+				srcColor[1] = (SampleComponent)customColor.c.f.magenta;
+				srcColor[2] = (SampleComponent)customColor.c.f.yellow;
+				srcColor[3] = (SampleComponent)customColor.c.f.black;
+				break;
+			}
+			case kCustomThreeColor:
+			{
+				// Pretty pointless :)
+				srcSpace = kAIRGBColorSpace;
+				srcColor[0] = (SampleComponent)customColor.c.rgb.red;
+				srcColor[1] = (SampleComponent)customColor.c.rgb.green;
+				srcColor[2] = (SampleComponent)customColor.c.rgb.blue;
+				break;
+			}
+			case kCustomLabColor:
+			{
+				break;
+			}
+			}
 			break;
 		}
-		case kCustomThreeColor:
+		case kThreeColor:
 		{
 			// Pretty pointless :)
 			srcSpace = kAIRGBColorSpace;
-			srcColor[0] = (SampleComponent)customColor.c.rgb.red;
-			srcColor[1] = (SampleComponent)customColor.c.rgb.green;
-			srcColor[2] = (SampleComponent)customColor.c.rgb.blue;
+			srcColor[0] = (SampleComponent)sourceColor.c.rgb.red;
+			srcColor[1] = (SampleComponent)sourceColor.c.rgb.green;
+			srcColor[2] = (SampleComponent)sourceColor.c.rgb.blue;
 			break;
 		}
-		case kCustomLabColor:
+		case kPattern:
+		case kGradient:
+		case kNoneColor:
 		{
 			break;
 		}
 		}
-		break;
-	}
-	case kThreeColor:
-	{
-		// Pretty pointless :)
-		srcSpace = kAIRGBColorSpace;
-		srcColor[0] = (SampleComponent)sourceColor.c.rgb.red;
-		srcColor[1] = (SampleComponent)sourceColor.c.rgb.green;
-		srcColor[2] = (SampleComponent)sourceColor.c.rgb.blue;
-		break;
-	}
-	case kPattern:
-	case kGradient:
-	case kNoneColor:
-	{
-		break;
-	}
-	}
 
-	// Perform the color conversion
-	sAIColorConversion->ConvertSampleColor(srcSpace, srcColor, dstSpace, dstColor, AIColorConvertOptions::kForExport, &inGamut);
+		// Perform the color conversion
+		sAIColorConversion->ConvertSampleColor(srcSpace, srcColor, dstSpace, dstColor, AIColorConvertOptions::kForExport, &inGamut);
 
-	rbgColor.kind = kThreeColor;
-	rbgColor.c.rgb.red = dstColor[0];
-	rbgColor.c.rgb.green = dstColor[1];
-	rbgColor.c.rgb.blue = dstColor[2];
+		rbgColor.kind = kThreeColor;
+		rbgColor.c.rgb.red = dstColor[0];
+		rbgColor.c.rgb.green = dstColor[1];
+		rbgColor.c.rgb.blue = dstColor[2];
+
+		// Remember the conversion
+		documentResources->colors.AddRGB(sourceColor, rbgColor);
+	}
 }
 
 void Canvas::TransformRect(AIRealRect& rect)
@@ -2675,46 +3448,66 @@ void Canvas::TransformPointWithMatrix(AIRealPoint& point, const AIRealMatrix& ma
 	}
 }
 
-void Canvas::AddBreadcrumb(const std::string& artName, unsigned int depth)
+void Canvas::AddBreadcrumb(AIArtHandle artHandle, unsigned int depth)
 {
-	// Are we under the maximum breadcrumb count?
-	if (breadcrumbs.size() < MAX_BREADCRUMB_DEPTH)
+	// Production code has no breadcrumbs (so the art name isn't even looked up), unless they go to the source map
+	if (!context->minify || context->sourceMap)
 	{
-		// Copy the string
-		std::string cleanArtName = artName;
-
-		// If this is at depth = 1, then make sure we clean any custom function names
-		if (depth == 1)
+		// Are we under the maximum breadcrumb count?
+		if (breadcrumbs.size() < MAX_BREADCRUMB_DEPTH)
 		{
-			// Remove parenthesis and parameters (if they exist)
-			CleanFunction(cleanArtName);
+			// Copy the art name (only fetched when it will be used)
+			std::string cleanArtName = documentResources->artInfo.GetUTF8Name(artHandle);
 
-			// Convert to camel-case
-			CleanString(cleanArtName, true);
-		}
+			// If this is at depth = 1, then make sure we clean any custom function names
+			if (depth == 1)
+			{
+				// Remove parenthesis and parameters (if they exist)
+				CleanFunction(cleanArtName);
 
-		// Strip invalid characters from art name
-		CleanString(cleanArtName, false);
+				// Convert to camel-case
+				CleanString(cleanArtName, true);
+			}
 
-		// Add clean name to breadcrumb
-		breadcrumbs.push_back(cleanArtName);
+			// Strip invalid characters from art name
+			CleanString(cleanArtName, false);
 
-		// Output path and name
-		if (depth > 1)
-		{
-			outFile << "// ";
+			// Add clean name to breadcrumb
+			breadcrumbs.push_back(cleanArtName);
 
-			// Loop through breadcrumbs
+			// Path to the art
+			std::string path;
 			for (unsigned int i = 0; i < breadcrumbs.size(); i++)
 			{
 				if (i > 0)
 				{
-					outFile << "/";
+					path += "/";
 				}
-				outFile << breadcrumbs[i];
+				path += breadcrumbs[i];
 			}
 
-			outFile << endl;
+			// Output path and name
+			if (depth > 1 && !context->minify)
+			{
+				context->out << "// " << path << endl;
+			}
+
+			// Lines that follow come from this art
+			if (context->sourceMap)
+			{
+				const std::string& uid = documentResources->artInfo.GetUID(artHandle);
+				breadcrumbSources.push_back(context->sourceMap->AddSource(uid.empty() ? path : path + "#" + uid));
+				context->SetSource(breadcrumbSources.back());
+			}
+		}
+		else
+		{
+			// Keep a placeholder, so RemoveBreadcrumb stays balanced (the art maps to its deepest ancestor)
+			breadcrumbs.push_back("");
+			if (context->sourceMap)
+			{
+				breadcrumbSources.push_back(breadcrumbSources.back());
+			}
 		}
 	}
 }
@@ -2722,5 +3515,25 @@ void Canvas::AddBreadcrumb(const std::string& artName, unsigned int depth)
 void Canvas::RemoveBreadcrumb()
 {
 	// Remove breadcrumb
-	breadcrumbs.pop_back();
+	if (!context->minify || context->sourceMap)
+	{
+		breadcrumbs.pop_back();
+	}
+
+	// Lines that follow come from the parent art again
+	if (context->sourceMap)
+	{
+		breadcrumbSources.pop_back();
+		context->SetSource(breadcrumbSources.empty() ? -1 : breadcrumbSources.back());
+	}
+}
+
+// Stop attributing output to a top-level group (once the group is done)
+void Canvas::EndReportGroup(AIArtHandle artHandle)
+{
+	if (reportGroup == artHandle && reportGroup)
+	{
+		context->report->End();
+		reportGroup = NULL;
+	}
 }
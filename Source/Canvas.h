@@ -29,7 +29,9 @@
 #include "Utility.h"
 #include <sstream>
 #include <stdint.h>
+#include <deque>
 #include "DocumentResources.h"
+#include "ArtTraversal.h"
 
 // Accommodate color component type based on SDK version
 #if kPluginInterfaceVersion > kPluginInterfaceVersion16001
@@ -40,27 +42,12 @@
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	enum RenderMode
 	{
 		RM_Painter,
 		RM_HitTest
 	};
 
-	// Drop shadow parameters
-	// NOTE: Should this move to State? That's where it is in the canvas spec.
-	struct DropShadow
-	{
-		AIReal			horz;						// Horizontal offset
-		AIReal			vert;						// Vertical offset
-		AIReal			blur;						// Blur amount
-		AIFillStyle		shadowStyle;				// Fill style
-		AIReal			opac;						// Opacity
-	};
-
 	// Handy structure to maintain glyph state
 	// TODO: Evaluate a better (cleaner) way to do this
 	struct GlyphState
@@ -72,32 +59,45 @@ namespace CanvasExport
 		AIBoolean		textFilled;
 		AIBoolean		textStroked;
 		AIColor			fillColor;
-		std::string		fillStyle;
-		std::string		strokeStyle;
-		std::string		fontName;
-		std::string		fontStyleName;
+		unsigned int	fillStyle;					// Interned (see StringTable)
+		unsigned int	strokeStyle;				// Interned
+		unsigned int	fontName;					// Interned
+		unsigned int	fontStyleName;				// Interned
 		AIStrokeStyle	strokeStyleValue;
 	};
 
 	/// Represents a HTML5 canvas element
-	class Canvas
+	class Canvas : public ArtVisitor
 	{
 	private:
 
 	public:
 
 		DocumentResources*					documentResources;		// Document resources
+		ExportContext*						context;				// Export this canvas is written to
 		std::string							id;						// Canvas element ID
 		AIReal								width;					// Width
 		AIReal								height;					// Height
 		AIBoolean							isHidden;				// Is this canvas hidden (i.e. for patterns)?
 		std::string							contextName;			// Name of the drawing context
 		State*								currentState;			// Pointer to the current drawing state
-		std::vector<State>					states;					// Stack of drawing states
+		std::deque<State>					states;					// Storage for the stack of drawing states (slots are reused, and never move)
+		size_t								stateCount;				// Number of states on the stack
 		AIPathStyle							pathfinderStyle;		// Style for PathFinder artwork
 		AIBoolean							usePathfinderStyle;		// Track special kPluginArt/Pathfinder style (seems "hacky")
 		std::vector<std::string>			breadcrumbs;			// Path to the artwork
+		std::vector<int>					breadcrumbSources;		// Source map index of each breadcrumb
+		AIArtHandle							reportGroup;			// Top-level group the report is attributing output to (NULL if none)
 		RenderMode							renderMode;				// Painter or hit-tester?
+		unsigned int						rasterDensities;		// Number of pixel densities (1x, 2x, ...) to rasterize fallback images at
+		std::string							glyphText;				// Escaped text for the current set of glyph runs (reused between lines)
+		std::vector<ATETextDOM::Unicode>	glyphContents;			// Contents of the current glyph run (reused between runs)
+		AIBoolean							textOutlines;			// Draw text with cached glyph outlines instead of fillText?
+		AIBoolean							isDefinition;			// Drawing a symbol or pattern definition? (its art is never edited, not even temporarily)
+		std::vector<AIArtHandle>			glyphOutlines;			// Outlines of the current text frame, one per inked glyph (reused between frames)
+		AIBoolean							textGroupOpen;			// Are glyph runs being drawn in a shared transform group?
+		GlyphState							textGroupState;			// Glyph state that opened the transform group
+		AIRealMatrix						textGroupInverse;		// Inverse of the group's transformation (to position runs within it)
 
 		Canvas(const std::string& id, DocumentResources* documentResources);
 		~Canvas();
@@ -106,50 +106,69 @@ namespace CanvasExport
 		void				PopState();
 		void				DebugInfo();
 
-		void				AddBreadcrumb(const std::string& artName, unsigned int depth);
+		void				AddBreadcrumb(AIArtHandle artHandle, unsigned int depth);
 		void				RemoveBreadcrumb();
+		void				EndReportGroup(AIArtHandle artHandle);
 
 		void				Render();
 		void				RenderImages();
 
 		void				RenderArt(AIArtHandle artHandle, unsigned int depth);
+		bool				Enter(AIArtHandle artHandle, unsigned int& depth) override;
+		bool				GetChildren(AIArtHandle artHandle, unsigned int depth, unsigned int pass, AIArtHandle& firstChild, unsigned int& childDepth) override;
+		void				Leave(AIArtHandle artHandle, unsigned int depth) override;
 		void				ParseArtStyle(AIArtHandle artHandle, ASInt32& postEffectCount,
 		    				              AIBlendingMode& blendingMode, AIBoolean& hasDropShadow, DropShadow& dropShadow);
+		void				ParseLiveEffects(AIArtStyleHandle artStyle, ParsedArtStyle& parsedStyle);
 		void				SetContextDrawingState(unsigned int depth);
 		void				RenderDropShadow(const DropShadow& dropShadow);
 		void				RenderUnsupportedArt(AIArtHandle artHandle, const std::string& fileName, unsigned int depth);
-		void				RasterizeArtToPNG(AIArtHandle artHandle, const std::string& path);
+		AIErr				RasterizeArtToPNG(AIArtHandle artHandle, const std::string& path, AIReal scale);
+		void				RasterizeArtVariants(AIArtHandle artHandle, Image* image, const std::string& baseName);
+		AIErr				MakePNG(AIArtHandle artHandle, const std::string& path, AIReal scale);
+		AIBoolean			RasterizeRasterSourceToPNG(AIArtHandle artHandle, const std::string& path);
 		void				GetPNGDimensions(const std::string& path, unsigned int& width, unsigned int& height);
 		uint32_t			ReverseInt(uint32_t i);
 		AIReal				GetJPGDPI(const std::string& path);
+		AIBoolean			GetJPGDimensions(const std::string& path, unsigned int& width, unsigned int& height, unsigned int& components, unsigned int& orientation);
+		AIBoolean			IsRasterFileUnchanged(AIArtHandle artHandle);
 		uint16_t			ReverseInt(uint16_t i);
 		void				ReportRasterRecordInfo(const AIRasterRecord& rasterRecord);
 		void				ReportColorSpaceInfo(ai::int16 colorSpace);
-		void				RenderGroupArt(AIArtHandle artHandle, unsigned int depth);
 		void				RenderPluginArt(AIArtHandle artHandle, unsigned int depth);
 		void				RenderSymbolArt(AIArtHandle artHandle, unsigned int depth);
 		void				RenderCompoundPathArt(AIArtHandle artHandle, unsigned int depth);
+		void				FinishCompoundPathArt(AIArtHandle artHandle, unsigned int depth);
 		void				RenderPathArt(AIArtHandle artHandle, unsigned int depth);
 		void				RenderPathFigure(AIArtHandle artHandle);
 		void				RenderSegment(AIPathSegment& previousSegment, AIPathSegment& segment);
 		void				RenderPathStyle(const AIPathStyle& style, unsigned int depth);
 		void				RenderPlacedArt(AIArtHandle artHandle, unsigned int depth);
-		void				RenderRasterArt(AIArtHandle artHandle);
+		void				RenderRasterArt(AIArtHandle artHandle, unsigned int depth);
 		void				RenderMidPointColor(const AIColor& color1, AIReal alpha1, const AIColor& color2, AIReal alpha2);
 		void				RenderGradient(const AIGradientStyle& gradientStyle, unsigned int depth);
 		void				RenderGradientStops(const AIGradientStyle& gradientStyle);
 		void				RenderFillInfo(const AIColor& fillColor, unsigned int depth);
-		void				GetFillStyle(const AIColor& color, AIReal alpha, std::string& fillStyle);
+		void				GetFillStyle(const AIColor& color, AIReal alpha, unsigned int& fillStyle);
 		void				ReportPatternStyleInfo(const AIPatternStyle& patternStyle);
 		void				RenderStrokeInfo(const AIStrokeStyle& strokeStyle);
 		void				RenderTextFrameArt(AIArtHandle artHandle, unsigned int depth);
 		void				RenderGlyphRuns(AIArtHandle textFrameArt, unsigned int depth);
-		void				RenderGlyphRun(char *contents, const GlyphState& glyphState, unsigned int depth);
+		void				RenderGlyphRun(const std::string& text, const GlyphState& glyphState, unsigned int depth);
+		void				RenderGlyphText(const std::string& text, const GlyphState& glyphState, AIReal x, AIReal y);
+		void				EndTextGroup(unsigned int depth);
 		AIBoolean			GlyphStatesMatch(const GlyphState& state1, const GlyphState& state2);
-		void				GetGlyphState(const ATE::IGlyphRun& glyphRun, GlyphState& glyphState, const AIRealMatrix& textFrameMatrix);
+		void				GetGlyphState(const ATE::ICharFeatures& features, GlyphState& glyphState);
+		void				GetGlyphMatrix(const AIRealMatrix& runMatrix, const AIRealPoint& glyphOrigin, const GlyphState& glyphState, const AIRealMatrix& textFrameMatrix, AIRealMatrix& glyphMatrix);
+		AIArtHandle			CreateGlyphOutlines(AIArtHandle textFrameArt, const ATE::ITextFrame& frame);
+		void				AddGlyphOutlines(AIArtHandle artHandle);
+		AIBoolean			IsBlankCharacter(ATETextDOM::Unicode c);
+		void				RenderGlyphOutlines(const ATE::IGlyphRun& glyphRun, const GlyphState& glyphState, const AIRealMatrix& textFrameMatrix, size_t length, size_t& outlineIndex, unsigned int depth);
+		void				GetGlyphPathData(AIArtHandle artHandle, const AIRealMatrix& inverseMatrix, AIReal fontSize, std::ostringstream& data);
 		void				ReportGlyphRunInfo(const ATE::IGlyphRun& glyphRun);
 		void				ReportCharacterFeatures(const ATE::ICharFeatures& features);
-		std::string			GetColor(const AIColor& color, AIReal alpha);
+		const std::string&	GetColor(const AIColor& color, AIReal alpha);
+		int					ToColorComponent(AIReal value);
 		void				ConvertColorToRGB(const AIColor& sourceColor, AIColor& rbgColor);
 		void				TransformRect(AIRealRect& rect);
 		void				TransformPoint(AIRealPoint& point);
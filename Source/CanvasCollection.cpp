@@ -27,17 +27,13 @@ using namespace CanvasExport;
 
 CanvasCollection::CanvasCollection()
 {
+	// Initialize CanvasCollection
+	this->arena = NULL;
 }
 
 CanvasCollection::~CanvasCollection()
 {
-	// Clear canvases
-	for (unsigned int i = 0; i < canvases.size(); i++)
-	{
-		// Remove instance
-		delete canvases[i];
-	}
-
+	// Instances are released with the arena
 }
 
 void CanvasCollection::Render()
@@ -55,16 +51,12 @@ Canvas* CanvasCollection::Find(const std::string& id)
 {
 	Canvas* result = NULL;
 
-	// Loop through canvases
-	for (unsigned int i = 0; i < canvases.size(); i++)
+	// Look up the ID
+	std::unordered_map<std::string, Canvas*>::const_iterator it = canvasIndex.find(id);
+	if (it != canvasIndex.end())
 	{
-		// Do the IDs match?
-		if (canvases[i]->id == id)
-		{
-			// Found a match
-			result = canvases[i];
-			break;
-		}
+		// Found a match
+		result = it->second;
 	}
 
 	// Return result
@@ -75,7 +67,7 @@ Canvas* CanvasCollection::Find(const std::string& id)
 Canvas* CanvasCollection::Add(const std::string& id, const std::string& contextName, DocumentResources* documentResources)
 {
 	// Create new canvas with ID
-	Canvas* canvas = new Canvas(id, documentResources);
+	Canvas* canvas = arena->Create<Canvas>(id, documentResources);
 
 	// Set context name
 	canvas->contextName = contextName;
@@ -83,6 +75,9 @@ Canvas* CanvasCollection::Add(const std::string& id, const std::string& contextN
 	// Add to array
 	canvases.push_back(canvas);
 
+	// Index by ID
+	canvasIndex[id] = canvas;
+
 	// Return
 	return canvas;
 }
@@ -24,27 +24,28 @@
 #define CANVASCOLLECTION_H
 
 #include "IllustratorSDK.h"
+#include "Arena.h"
 #include "Canvas.h"
 #include "Utility.h"
+#include <unordered_map>
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents a collection of canvases
 	class CanvasCollection
 	{
 	private:
 
 		std::vector<Canvas*>	canvases;			// Collection of canvas pointers
+		std::unordered_map<std::string, Canvas*>	canvasIndex;	// Canvases (by ID)
 
 	public:
 
 		CanvasCollection();
 		~CanvasCollection();
 
+		Arena*					arena;				// Arena that owns the canvases
+
 		void					Render();
 		Canvas*					Add(const std::string& id, const std::string& contextName, DocumentResources* documentResources);
 		Canvas*					Find(const std::string& id);
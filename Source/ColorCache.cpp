@@ -0,0 +1,216 @@
+// ColorCache.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "ColorCache.h"
+
+using namespace CanvasExport;
+
+// Typical documents have far fewer distinct colors than fills, so this avoids early rehashing without wasting memory
+#define COLOR_CACHE_INITIAL_SIZE 1024
+
+ColorCache::ColorCache()
+{
+	// Initialize ColorCache
+	this->conversionHits = 0;
+	this->conversionMisses = 0;
+	this->conversions.reserve(COLOR_CACHE_INITIAL_SIZE);
+	this->colorStrings.reserve(COLOR_CACHE_INITIAL_SIZE);
+}
+
+ColorCache::~ColorCache()
+{
+}
+
+bool ColorCache::ColorKey::operator==(const ColorKey& other) const
+{
+	return kind == other.kind &&
+		components[0] == other.components[0] &&
+		components[1] == other.components[1] &&
+		components[2] == other.components[2] &&
+		components[3] == other.components[3] &&
+		handle == other.handle;
+}
+
+size_t ColorCache::ColorKeyHash::operator()(const ColorKey& key) const
+{
+	// Combine the fields (boost::hash_combine style)
+	size_t seed = std::hash<short>()(key.kind);
+	for (int i = 0; i < 4; i++)
+	{
+		seed ^= std::hash<AIReal>()(key.components[i]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+	seed ^= std::hash<void*>()(key.handle) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	return seed;
+}
+
+// Build the cache key for a color
+ColorCache::ColorKey ColorCache::MakeKey(const AIColor& color)
+{
+	ColorKey key;
+	key.kind = color.kind;
+	key.components[0] = 0.0f;
+	key.components[1] = 0.0f;
+	key.components[2] = 0.0f;
+	key.components[3] = 0.0f;
+	key.handle = NULL;
+
+	switch (color.kind)
+	{
+	case kGrayColor:
+	{
+		key.components[0] = color.c.g.gray;
+		break;
+	}
+	case kFourColor:
+	{
+		key.components[0] = color.c.f.cyan;
+		key.components[1] = color.c.f.magenta;
+		key.components[2] = color.c.f.yellow;
+		key.components[3] = color.c.f.black;
+		break;
+	}
+	case kThreeColor:
+	{
+		key.components[0] = color.c.rgb.red;
+		key.components[1] = color.c.rgb.green;
+		key.components[2] = color.c.rgb.blue;
+		break;
+	}
+	case kCustomColor:
+	{
+		// The conversion only depends on the custom color (not its tint)
+		key.handle = color.c.c.color;
+		break;
+	}
+	default:
+	{
+		// Patterns, gradients and "none" have no components
+		break;
+	}
+	}
+
+	return key;
+}
+
+// Find a previous RGB conversion of a color, returns false if there isn't one
+bool ColorCache::FindRGB(const AIColor& color, AIColor& rgbColor)
+{
+	bool found = false;
+
+	std::unordered_map<ColorKey, AIColor, ColorKeyHash>::const_iterator it = conversions.find(MakeKey(color));
+	if (it != conversions.end())
+	{
+		rgbColor = it->second;
+		found = true;
+		conversionHits++;
+	}
+	else
+	{
+		conversionMisses++;
+	}
+
+	return found;
+}
+
+// Remember the RGB conversion of a color
+void ColorCache::AddRGB(const AIColor& color, const AIColor& rgbColor)
+{
+	conversions[MakeKey(color)] = rgbColor;
+}
+
+// Returns the shortest CSS color string (including double quotes) for 0-255 components and an alpha value
+// Opaque colors use "#rgb" or "#rrggbb", others use "rgba(r,g,b,.5)"
+const std::string& ColorCache::GetColorString(int red, int green, int blue, AIReal alpha)
+{
+	// Alpha is written with two decimals, so that's all that can make strings differ
+	int alphaPercent = (int)floor((alpha * 100.0f) + 0.5f);
+	alphaPercent = std::max(0, std::min(100, alphaPercent));
+
+	// Pack the key
+	uint32_t key = ((uint32_t)(red & 0xff) << 24) | ((uint32_t)(green & 0xff) << 16) | ((uint32_t)(blue & 0xff) << 8) | (uint32_t)alphaPercent;
+
+	// Have we formatted this one before?
+	std::unordered_map<uint32_t, std::string>::iterator it = colorStrings.find(key);
+	if (it != colorStrings.end())
+	{
+		return it->second;
+	}
+
+	// Format the color
+	static const char hexDigits[] = "0123456789abcdef";
+	std::string colorString;
+	if (alphaPercent == 100)
+	{
+		// Can we use the short form? (each component has two identical digits)
+		if (((red >> 4) == (red & 0xf)) && ((green >> 4) == (green & 0xf)) && ((blue >> 4) == (blue & 0xf)))
+		{
+			colorString = "\"#";
+			colorString += hexDigits[red & 0xf];
+			colorString += hexDigits[green & 0xf];
+			colorString += hexDigits[blue & 0xf];
+			colorString += "\"";
+		}
+		else
+		{
+			colorString = "\"#";
+			colorString += hexDigits[(red >> 4) & 0xf];
+			colorString += hexDigits[red & 0xf];
+			colorString += hexDigits[(green >> 4) & 0xf];
+			colorString += hexDigits[green & 0xf];
+			colorString += hexDigits[(blue >> 4) & 0xf];
+			colorString += hexDigits[blue & 0xf];
+			colorString += "\"";
+		}
+	}
+	else
+	{
+		// Alpha without a leading zero or trailing zeros (".5", ".05", "0")
+		std::ostringstream alphaValue;
+		if (alphaPercent == 0)
+		{
+			alphaValue << "0";
+		}
+		else if (alphaPercent % 10 == 0)
+		{
+			alphaValue << "." << (alphaPercent / 10);
+		}
+		else
+		{
+			alphaValue << "." << (alphaPercent < 10 ? "0" : "") << alphaPercent;
+		}
+
+		std::ostringstream colorValue;
+		colorValue << "\"rgba(" << red << "," << green << "," << blue << "," << alphaValue.str() << ")\"";
+		colorString = colorValue.str();
+	}
+
+	// Remember it
+	return colorStrings[key] = colorString;
+}
+
+void ColorCache::DebugInfo(std::ostream& out)
+{
+	// Cache statistics
+	out << "//   Color conversions = " << conversionMisses << ", cache hits = " << conversionHits << endl;
+	out << "//   Distinct colors = " << conversions.size() << ", color strings = " << colorStrings.size() << endl;
+}
@@ -0,0 +1,74 @@
+// ColorCache.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef COLORCACHE_H
+#define COLORCACHE_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include <unordered_map>
+
+namespace CanvasExport
+{
+	/// Remembers RGB conversions and CSS color strings, so each distinct color is only converted and formatted once
+	class ColorCache
+	{
+	private:
+
+		/// Identifies a source color (only the fields used by its kind are set)
+		struct ColorKey
+		{
+			short				kind;				// Color kind
+			AIReal				components[4];		// Gray, CMYK or RGB components (unused ones are 0)
+			void*				handle;				// Custom color handle (NULL if not a custom color)
+
+			bool operator==(const ColorKey& other) const;
+		};
+
+		/// Hashes a ColorKey
+		struct ColorKeyHash
+		{
+			size_t operator()(const ColorKey& key) const;
+		};
+
+		std::unordered_map<ColorKey, AIColor, ColorKeyHash>	conversions;	// RGB colors (by source color)
+		std::unordered_map<uint32_t, std::string>			colorStrings;	// CSS color strings (by packed red, green, blue and alpha)
+
+		ColorKey			MakeKey(const AIColor& color);
+
+	public:
+
+		ColorCache();
+		~ColorCache();
+
+		unsigned int		conversionHits;			// Conversions answered by the cache
+		unsigned int		conversionMisses;		// Conversions that had to be made
+
+		bool				FindRGB(const AIColor& color, AIColor& rgbColor);
+		void				AddRGB(const AIColor& color, const AIColor& rgbColor);
+		const std::string&	GetColorString(int red, int green, int blue, AIReal alpha);
+		void				DebugInfo(std::ostream& out);
+
+	};
+}
+
+#endif
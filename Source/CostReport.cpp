@@ -0,0 +1,327 @@
+// CostReport.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "CostReport.h"
+#include "Utility.h"
+
+using namespace CanvasExport;
+
+// Report names of the call kinds
+static const char* kCallNames[CostReport::kCallKinds] = { "path", "fill", "stroke", "saveRestore", "transform", "clip",
+	"gradient", "pattern", "drawImage", "text", "other" };
+
+// Estimated cost of each kind of call (in rough units of one path segment)
+// Fills and strokes rasterize the current path, clips and patterns force extra compositing work
+static const double kCallCosts[CostReport::kCallKinds] = { 1.0, 8.0, 10.0, 2.0, 2.0, 12.0, 6.0, 20.0, 20.0, 25.0, 2.0 };
+
+// Estimated cost of drawing one image pixel
+static const double kPixelCost = 1.0 / 4096.0;
+
+// Escape text for HTML
+static std::string EscapeHTML(const std::string& s)
+{
+	std::string result;
+	for (size_t i = 0; i < s.length(); i++)
+	{
+		switch (s[i])
+		{
+		case '<': { result += "&lt;"; break; }
+		case '>': { result += "&gt;"; break; }
+		case '&': { result += "&amp;"; break; }
+		case '"': { result += "&quot;"; break; }
+		default: { result += s[i]; break; }
+		}
+	}
+	return result;
+}
+
+// Is this an identifier character?
+static bool IsIdentifierChar(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+CostReport::CostReport()
+{
+	// Initialize CostReport (the document holds everything)
+	this->outputStallSeconds = 0.0;
+	Begin("document", "");
+}
+
+CostReport::~CostReport()
+{
+}
+
+// Start attributing output to a function, layer or group (inside the current one)
+void CostReport::Begin(const std::string& type, const std::string& name)
+{
+	Entry entry = Entry();
+	entry.type = type;
+	entry.name = name;
+	entry.level = (unsigned int)scopes.size();
+
+	scopes.push_back(entries.size());
+	entries.push_back(entry);
+}
+
+// Stop attributing output to the current scope (the document stays open)
+void CostReport::End()
+{
+	if (scopes.size() > 1)
+	{
+		scopes.pop_back();
+	}
+}
+
+// Is a layer the innermost scope?
+bool CostReport::IsInLayer() const
+{
+	return (entries[scopes.back()].type == "layer");
+}
+
+// Returns the kind of canvas call a line of code makes (kCallKinds if it doesn't make one)
+// Recognizes "object.method(" and "variable = object.method(", which covers all the calls the exporter writes
+CostReport::CallKind CostReport::Classify(const std::string& line)
+{
+	// Method kinds (built once, thread-safe)
+	static const std::map<std::string, CallKind> methods = []()
+	{
+		std::map<std::string, CallKind> kinds;
+		const char* paths[] = { "beginPath", "moveTo", "lineTo", "bezierCurveTo", "quadraticCurveTo", "closePath", "rect", "arc", "arcTo", "ellipse" };
+		for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) kinds[paths[i]] = kPath;
+		kinds["fill"] = kFill;
+		kinds["fillRect"] = kFill;
+		kinds["stroke"] = kStroke;
+		kinds["strokeRect"] = kStroke;
+		kinds["save"] = kState;
+		kinds["restore"] = kState;
+		kinds["transform"] = kTransform;
+		kinds["setTransform"] = kTransform;
+		kinds["translate"] = kTransform;
+		kinds["rotate"] = kTransform;
+		kinds["scale"] = kTransform;
+		kinds["clip"] = kClip;
+		kinds["createLinearGradient"] = kGradient;
+		kinds["createRadialGradient"] = kGradient;
+		kinds["addColorStop"] = kGradient;
+		kinds["createPattern"] = kPattern;
+		kinds["drawImage"] = kImage;
+		kinds["fillText"] = kText;
+		kinds["strokeText"] = kText;
+		return kinds;
+	}();
+
+	CallKind kind = kCallKinds;
+
+	// Object (or the variable being assigned)
+	size_t position = line.find_first_not_of(' ');
+	size_t start = position;
+	while (position < line.length() && IsIdentifierChar(line[position]))
+	{
+		position++;
+	}
+
+	// Assignment? The object follows
+	if (position > start && line.compare(position, 3, " = ") == 0)
+	{
+		position += 3;
+		start = position;
+		while (position < line.length() && IsIdentifierChar(line[position]))
+		{
+			position++;
+		}
+	}
+
+	// Method
+	if (position > start && position < line.length() && line[position] == '.')
+	{
+		start = ++position;
+		while (position < line.length() && IsIdentifierChar(line[position]))
+		{
+			position++;
+		}
+		if (position > start && position < line.length() && line[position] == '(')
+		{
+			std::map<std::string, CallKind>::const_iterator iter = methods.find(line.substr(start, position - start));
+			kind = (iter != methods.end()) ? iter->second : kOther;
+		}
+	}
+
+	return kind;
+}
+
+// Count a line of code (and the call it makes) in every open scope
+void CostReport::AddLine(const std::string& line, size_t indentation)
+{
+	CallKind kind = Classify(line);
+
+	for (size_t i = 0; i < scopes.size(); i++)
+	{
+		Entry& entry = entries[scopes[i]];
+		entry.bytes += indentation + line.length() + 1;
+		if (kind != kCallKinds)
+		{
+			entry.calls[kind]++;
+		}
+	}
+}
+
+// Count an image that's drawn in every open scope
+void CostReport::AddImage(const std::string& path, bool isAbsolute, const std::vector<std::string>& variants,
+	unsigned int width, unsigned int height)
+{
+	// Files (relative paths start at the document's folder)
+	uint64_t bytes = GetFileSize(isAbsolute ? path : folderPath + path);
+	for (size_t i = 0; i < variants.size(); i++)
+	{
+		bytes += GetFileSize(folderPath + variants[i]);
+	}
+
+	for (size_t i = 0; i < scopes.size(); i++)
+	{
+		Entry& entry = entries[scopes[i]];
+		entry.images++;
+		entry.imageBytes += bytes;
+		entry.imagePixels += (uint64_t)width * height;
+	}
+}
+
+// Returns the size of a file (0 if it can't be read), asking the file system only once per file
+uint64_t CostReport::GetFileSize(const std::string& path)
+{
+	std::map<std::string, uint64_t>::iterator iter = fileSizes.find(path);
+	if (iter != fileSizes.end())
+	{
+		return iter->second;
+	}
+
+	uint64_t size = 0;
+	std::ifstream file(path.c_str(), ios::in | ios::binary | ios::ate);
+	if (file.is_open())
+	{
+		size = (uint64_t)file.tellg();
+	}
+	fileSizes[path] = size;
+	return size;
+}
+
+// Estimated draw cost of an entry
+double CostReport::GetCost(const Entry& entry)
+{
+	double cost = entry.imagePixels * kPixelCost;
+	for (int i = 0; i < kCallKinds; i++)
+	{
+		cost += entry.calls[i] * kCallCosts[i];
+	}
+	return cost;
+}
+
+// Write the report as JSON
+bool CostReport::WriteJSON(const std::string& path)
+{
+	std::ofstream reportFile(path.c_str(), ios::out | ios::trunc);
+	if (!reportFile.is_open())
+	{
+		return false;
+	}
+
+	reportFile << "{" << endl;
+	reportFile << "  \"outputStallSeconds\": " << setiosflags(ios::fixed) << setprecision(3) << outputStallSeconds << "," << endl;
+	reportFile << "  \"entries\": [";
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const Entry& entry = entries[i];
+		reportFile << (i > 0 ? "," : "") << endl;
+		reportFile << "    { \"type\": \"" << entry.type << "\", " <<
+			"\"name\": \"" << EscapeJSON(entry.name) << "\", " <<
+			"\"level\": " << entry.level << ", " <<
+			"\"bytes\": " << entry.bytes << ", " <<
+			"\"calls\": { ";
+		for (int j = 0; j < kCallKinds; j++)
+		{
+			reportFile << (j > 0 ? ", " : "") << "\"" << kCallNames[j] << "\": " << entry.calls[j];
+		}
+		reportFile << " }, " <<
+			"\"images\": " << entry.images << ", " <<
+			"\"imageBytes\": " << entry.imageBytes << ", " <<
+			"\"imagePixels\": " << entry.imagePixels << ", " <<
+			"\"cost\": " << setiosflags(ios::fixed) << setprecision(1) << GetCost(entry) << " }";
+	}
+	reportFile << endl << "  ]" << endl;
+	reportFile << "}" << endl;
+
+	return !reportFile.fail();
+}
+
+// Write the report as an HTML table (indented by nesting, with each entry's share of the document)
+bool CostReport::WriteHTML(const std::string& path)
+{
+	std::ofstream reportFile(path.c_str(), ios::out | ios::trunc);
+	if (!reportFile.is_open())
+	{
+		return false;
+	}
+
+	const Entry& document = entries[0];
+	double documentCost = GetCost(document);
+
+	reportFile << "<!DOCTYPE html>" << endl;
+	reportFile << "<html><head><meta charset=\"utf-8\"><title>Export cost report</title>" << endl;
+	reportFile << "<style>body { font-family: sans-serif; } td, th { padding: 2px 8px; text-align: right; } " <<
+		"td:first-child, th:first-child { text-align: left; white-space: nowrap; }</style></head><body>" << endl;
+	reportFile << "<table>" << endl;
+	reportFile << "<tr><th>Name</th><th>Bytes</th><th>% bytes</th>";
+	for (int j = 0; j < kCallKinds; j++)
+	{
+		reportFile << "<th>" << kCallNames[j] << "</th>";
+	}
+	reportFile << "<th>Images</th><th>Image bytes</th><th>Cost</th><th>% cost</th></tr>" << endl;
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const Entry& entry = entries[i];
+		double cost = GetCost(entry);
+
+		reportFile << "<tr><td style=\"padding-left: " << (entry.level * 16 + 8) << "px\">" <<
+			EscapeHTML(entry.type) << (entry.name.empty() ? "" : " ") << EscapeHTML(entry.name) << "</td>" <<
+			"<td>" << entry.bytes << "</td>" <<
+			"<td>" << setiosflags(ios::fixed) << setprecision(1) << (document.bytes ? 100.0 * entry.bytes / document.bytes : 0.0) << "</td>";
+		for (int j = 0; j < kCallKinds; j++)
+		{
+			reportFile << "<td>" << entry.calls[j] << "</td>";
+		}
+		reportFile << "<td>" << entry.images << "</td>" <<
+			"<td>" << entry.imageBytes << "</td>" <<
+			"<td>" << cost << "</td>" <<
+			"<td>" << (documentCost > 0.0 ? 100.0 * cost / documentCost : 0.0) << "</td></tr>" << endl;
+	}
+
+	reportFile << "</table>" << endl;
+
+	// Time spent waiting on the disk isn't attributed to any artwork
+	reportFile << "<p>Waited " << setiosflags(ios::fixed) << setprecision(3) << outputStallSeconds <<
+		" seconds for the output file to be written</p>" << endl;
+	reportFile << "</body></html>" << endl;
+
+	return !reportFile.fail();
+}
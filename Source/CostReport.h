@@ -0,0 +1,85 @@
+// CostReport.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef COSTREPORT_H
+#define COSTREPORT_H
+
+#include "IllustratorSDK.h"
+#include <map>
+#include <vector>
+
+namespace CanvasExport
+{
+	/// Attributes output size and drawing work to each draw function, layer and top-level group, so designers can see
+	/// which artwork makes a page slow
+	/// Canvas calls are counted from the lines that are written, so every kind of art is covered without bookkeeping
+	/// at each call site
+	class CostReport
+	{
+	public:
+
+		enum CallKind { kPath, kFill, kStroke, kState, kTransform, kClip, kGradient, kPattern, kImage, kText, kOther, kCallKinds };
+
+		/// Totals for a function, layer or group (including everything inside it)
+		struct Entry
+		{
+			std::string			type;					// "document", "function", "layer" or "group"
+			std::string			name;					// Name of the function, layer or group
+			unsigned int		level;					// Nesting level (0 for the document)
+			uint64_t			bytes;					// Bytes of code written
+			unsigned int		calls[kCallKinds];		// Canvas calls by kind
+			unsigned int		images;					// Images drawn
+			uint64_t			imageBytes;				// Bytes of the image files drawn (including density variants)
+			uint64_t			imagePixels;			// Pixels of the images drawn (at 1x)
+		};
+
+	private:
+
+		std::vector<Entry>		entries;				// Document, then each scope in the order it started
+		std::vector<size_t>		scopes;					// Open scopes (indexes into entries)
+		std::map<std::string, uint64_t>	fileSizes;		// Size of each image file (by path)
+
+		static CallKind			Classify(const std::string& line);
+		uint64_t				GetFileSize(const std::string& path);
+
+	public:
+
+		CostReport();
+		~CostReport();
+
+		std::string				folderPath;				// Where relative image paths start
+		double					outputStallSeconds;		// Time the export waited for the output file to be written
+
+		void					Begin(const std::string& type, const std::string& name);
+		void					End();
+		bool					IsInLayer() const;
+		void					AddLine(const std::string& line, size_t indentation);
+		void					AddImage(const std::string& path, bool isAbsolute, const std::vector<std::string>& variants,
+									unsigned int width, unsigned int height);
+		static double			GetCost(const Entry& entry);
+		bool					WriteJSON(const std::string& path);
+		bool					WriteHTML(const std::string& path);
+
+	};
+}
+
+#endif
@@ -0,0 +1,465 @@
+// Deflate.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "Deflate.h"
+#include <algorithm>
+#include <queue>
+
+using namespace CanvasExport;
+
+// Length and distance codes (RFC 1951, section 3.2.5)
+static const unsigned short kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+	67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const unsigned char kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4,
+	5, 5, 5, 5, 0 };
+static const unsigned short kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+	513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const unsigned char kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10,
+	10, 11, 11, 12, 12, 13, 13 };
+
+// Order the code length code lengths are written in
+static const unsigned char kCodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+Deflate::Deflate()
+{
+	// Initialize Deflate
+	this->bufferStart = 0;
+	this->position = 0;
+	this->head.assign((size_t)1 << kHashBits, -1);
+	this->previous.assign(kWindowSize, -1);
+	this->literalFrequencies.assign(286, 0);
+	this->distanceFrequencies.assign(30, 0);
+	this->bitBuffer = 0;
+	this->bitCount = 0;
+}
+
+Deflate::~Deflate()
+{
+}
+
+// Compress input, appending the compressed bytes to out
+// The last few hundred bytes are held back (to find matches that continue into the next input), until isFinal is set
+void Deflate::Compress(const char* data, size_t size, bool isFinal, std::string& out)
+{
+	buffer.insert(buffer.end(), (const unsigned char*)data, (const unsigned char*)data + size);
+	uint64_t end = bufferStart + buffer.size();
+
+	while (position < end)
+	{
+		// Wait for more input if a match could continue past the end
+		size_t available = (size_t)(end - position);
+		if (!isFinal && available < kMaxMatch)
+		{
+			break;
+		}
+
+		// Look for a match
+		size_t distance = 0;
+		size_t length = FindMatch(position, available, distance);
+		Insert(position);
+
+		// Would the match that starts at the next byte be longer? (lazy matching)
+		if (length >= kMinMatch && length < 32 && available > length)
+		{
+			size_t nextDistance = 0;
+			if (FindMatch(position + 1, available - 1, nextDistance) > length)
+			{
+				length = 0;
+			}
+		}
+
+		Symbol symbol;
+		if (length >= kMinMatch)
+		{
+			// Match
+			symbol.length = (unsigned short)length;
+			symbol.distance = (unsigned short)distance;
+			literalFrequencies[257 + (std::upper_bound(kLengthBase, kLengthBase + 29, length) - kLengthBase - 1)]++;
+			distanceFrequencies[std::upper_bound(kDistanceBase, kDistanceBase + 30, distance) - kDistanceBase - 1]++;
+
+			// Remember the matched bytes (so later matches can start inside them)
+			for (size_t i = 1; i < length; i++)
+			{
+				Insert(position + i);
+			}
+			position += length;
+		}
+		else
+		{
+			// Literal
+			symbol.length = buffer[(size_t)(position - bufferStart)];
+			symbol.distance = 0;
+			literalFrequencies[symbol.length]++;
+			position++;
+		}
+		symbols.push_back(symbol);
+	}
+
+	// Write what we have
+	if (!symbols.empty() || isFinal)
+	{
+		WriteBlock(isFinal, out);
+	}
+
+	// Keep no more than the window (and the held back input)
+	if (position - bufferStart > 2 * kWindowSize)
+	{
+		size_t drop = (size_t)(position - kWindowSize - bufferStart);
+		buffer.erase(buffer.begin(), buffer.begin() + drop);
+		bufferStart += drop;
+	}
+
+	// The stream ends on a byte boundary
+	if (isFinal && bitCount > 0)
+	{
+		WriteBits(0, 8 - bitCount, out);
+	}
+}
+
+// Hash the three bytes at a stream position
+size_t Deflate::HashAt(uint64_t at) const
+{
+	const unsigned char* p = &buffer[(size_t)(at - bufferStart)];
+	uint32_t value = p[0] | (p[1] << 8) | (p[2] << 16);
+	return (size_t)((value * 2654435761u) >> (32 - kHashBits));
+}
+
+// Add a stream position to the hash chains
+void Deflate::Insert(uint64_t at)
+{
+	if (at + kMinMatch <= bufferStart + buffer.size())
+	{
+		size_t hash = HashAt(at);
+		previous[(size_t)(at & (kWindowSize - 1))] = head[hash];
+		head[hash] = (int64_t)at;
+	}
+}
+
+// Find the longest match for the bytes at a stream position
+// Returns the length of the match (0 if none)
+size_t Deflate::FindMatch(uint64_t at, size_t available, size_t& distance)
+{
+	size_t best = 0;
+	if (available >= kMinMatch)
+	{
+		size_t maxLength = std::min(available, (size_t)kMaxMatch);
+		int64_t limit = (int64_t)std::max(bufferStart, at > kWindowSize ? at - kWindowSize : 0);
+		const unsigned char* current = &buffer[(size_t)(at - bufferStart)];
+
+		int64_t candidate = head[HashAt(at)];
+		int chain = kMaxChain;
+		while (candidate >= limit && chain-- > 0)
+		{
+			// Compare (checking the byte that would make it the best match first)
+			const unsigned char* match = &buffer[(size_t)(candidate - bufferStart)];
+			if (match[best] == current[best])
+			{
+				size_t length = 0;
+				while (length < maxLength && match[length] == current[length])
+				{
+					length++;
+				}
+				if (length > best)
+				{
+					best = length;
+					distance = (size_t)(at - candidate);
+					if (best == maxLength)
+					{
+						break;
+					}
+				}
+			}
+
+			// Next candidate (chains are overwritten as the window moves, so stop if it isn't older)
+			int64_t next = previous[(size_t)(candidate & (kWindowSize - 1))];
+			if (next >= candidate)
+			{
+				break;
+			}
+			candidate = next;
+		}
+	}
+
+	return (best >= kMinMatch) ? best : 0;
+}
+
+// Write the symbols of the current block with dynamic Huffman codes
+void Deflate::WriteBlock(bool isFinal, std::string& out)
+{
+	// End of block
+	literalFrequencies[256]++;
+
+	// Build the codes
+	std::vector<int> literalLengths, distanceLengths;
+	BuildLengths(literalFrequencies, 15, literalLengths);
+	BuildLengths(distanceFrequencies, 15, distanceLengths);
+	std::vector<uint32_t> literalCodes, distanceCodes;
+	BuildCodes(literalLengths, literalCodes);
+	BuildCodes(distanceLengths, distanceCodes);
+
+	// How many lengths do we need to send?
+	size_t literalCount = 286;
+	while (literalCount > 257 && literalLengths[literalCount - 1] == 0)
+	{
+		literalCount--;
+	}
+	size_t distanceCount = 30;
+	while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0)
+	{
+		distanceCount--;
+	}
+
+	// Run-length encode the lengths
+	std::vector<int> lengths(literalLengths.begin(), literalLengths.begin() + literalCount);
+	lengths.insert(lengths.end(), distanceLengths.begin(), distanceLengths.begin() + distanceCount);
+	std::vector<Symbol> runs;
+	std::vector<uint32_t> codeLengthFrequencies(19, 0);
+	for (size_t i = 0; i < lengths.size();)
+	{
+		int length = lengths[i];
+		size_t run = 1;
+		while (i + run < lengths.size() && lengths[i + run] == length)
+		{
+			run++;
+		}
+		i += run;
+
+		Symbol symbol;
+		if (length == 0)
+		{
+			// Runs of zeros
+			while (run >= 3)
+			{
+				size_t count = std::min(run, (size_t)138);
+				symbol.length = (count >= 11) ? 18 : 17;
+				symbol.distance = (unsigned short)(count - ((count >= 11) ? 11 : 3));
+				runs.push_back(symbol);
+				run -= count;
+			}
+		}
+		else
+		{
+			// The length, then repeats of it
+			symbol.length = (unsigned short)length;
+			symbol.distance = 0;
+			runs.push_back(symbol);
+			run--;
+			while (run >= 3)
+			{
+				size_t count = std::min(run, (size_t)6);
+				symbol.length = 16;
+				symbol.distance = (unsigned short)(count - 3);
+				runs.push_back(symbol);
+				run -= count;
+			}
+		}
+
+		// Anything left is written as is
+		symbol.length = (unsigned short)length;
+		symbol.distance = 0;
+		runs.insert(runs.end(), run, symbol);
+	}
+	for (size_t i = 0; i < runs.size(); i++)
+	{
+		codeLengthFrequencies[runs[i].length]++;
+	}
+
+	// Code length codes
+	std::vector<int> codeLengthLengths;
+	std::vector<uint32_t> codeLengthCodes;
+	BuildLengths(codeLengthFrequencies, 7, codeLengthLengths);
+	BuildCodes(codeLengthLengths, codeLengthCodes);
+	size_t codeLengthCount = 19;
+	while (codeLengthCount > 4 && codeLengthLengths[kCodeLengthOrder[codeLengthCount - 1]] == 0)
+	{
+		codeLengthCount--;
+	}
+
+	// Block header
+	WriteBits(isFinal ? 1 : 0, 1, out);
+	WriteBits(2, 2, out);
+	WriteBits((uint32_t)(literalCount - 257), 5, out);
+	WriteBits((uint32_t)(distanceCount - 1), 5, out);
+	WriteBits((uint32_t)(codeLengthCount - 4), 4, out);
+	for (size_t i = 0; i < codeLengthCount; i++)
+	{
+		WriteBits(codeLengthLengths[kCodeLengthOrder[i]], 3, out);
+	}
+	for (size_t i = 0; i < runs.size(); i++)
+	{
+		const Symbol& run = runs[i];
+		WriteBits(codeLengthCodes[run.length], codeLengthLengths[run.length], out);
+		switch (run.length)
+		{
+		case 16: { WriteBits(run.distance, 2, out); break; }
+		case 17: { WriteBits(run.distance, 3, out); break; }
+		case 18: { WriteBits(run.distance, 7, out); break; }
+		}
+	}
+
+	// Symbols
+	for (size_t i = 0; i < symbols.size(); i++)
+	{
+		const Symbol& symbol = symbols[i];
+		if (symbol.distance == 0)
+		{
+			WriteBits(literalCodes[symbol.length], literalLengths[symbol.length], out);
+		}
+		else
+		{
+			size_t lengthCode = std::upper_bound(kLengthBase, kLengthBase + 29, symbol.length) - kLengthBase - 1;
+			WriteBits(literalCodes[257 + lengthCode], literalLengths[257 + lengthCode], out);
+			WriteBits(symbol.length - kLengthBase[lengthCode], kLengthExtra[lengthCode], out);
+
+			size_t distanceCode = std::upper_bound(kDistanceBase, kDistanceBase + 30, symbol.distance) - kDistanceBase - 1;
+			WriteBits(distanceCodes[distanceCode], distanceLengths[distanceCode], out);
+			WriteBits(symbol.distance - kDistanceBase[distanceCode], kDistanceExtra[distanceCode], out);
+		}
+	}
+	WriteBits(literalCodes[256], literalLengths[256], out);
+
+	// Start the next block
+	symbols.clear();
+	std::fill(literalFrequencies.begin(), literalFrequencies.end(), 0);
+	std::fill(distanceFrequencies.begin(), distanceFrequencies.end(), 0);
+}
+
+// Write bits (least significant first)
+void Deflate::WriteBits(uint32_t value, int count, std::string& out)
+{
+	bitBuffer |= (uint64_t)value << bitCount;
+	bitCount += count;
+	while (bitCount >= 8)
+	{
+		out.push_back((char)(bitBuffer & 0xFF));
+		bitBuffer >>= 8;
+		bitCount -= 8;
+	}
+}
+
+// Build Huffman code lengths from symbol frequencies, no longer than maxLength
+void Deflate::BuildLengths(const std::vector<uint32_t>& frequencies, int maxLength, std::vector<int>& lengths)
+{
+	// Inflaters reject codes with a single symbol, so make sure there are at least two
+	std::vector<uint32_t> weights(frequencies);
+	size_t used = weights.size() - std::count(weights.begin(), weights.end(), 0u);
+	for (size_t i = 0; i < weights.size() && used < 2; i++)
+	{
+		if (weights[i] == 0)
+		{
+			weights[i] = 1;
+			used++;
+		}
+	}
+
+	for (;;)
+	{
+		// Build the tree (leaves first, then the nodes that join them)
+		typedef std::pair<uint64_t, size_t> Node;
+		std::priority_queue<Node, std::vector<Node>, std::greater<Node> > queue;
+		std::vector<size_t> parents(weights.size(), 0);
+		for (size_t i = 0; i < weights.size(); i++)
+		{
+			if (weights[i] > 0)
+			{
+				queue.push(Node(weights[i], i));
+			}
+		}
+		while (queue.size() > 1)
+		{
+			Node a = queue.top();
+			queue.pop();
+			Node b = queue.top();
+			queue.pop();
+			size_t parent = parents.size();
+			parents.push_back(0);
+			parents[a.second] = parent;
+			parents[b.second] = parent;
+			queue.push(Node(a.first + b.first, parent));
+		}
+		size_t root = parents.size() - 1;
+
+		// Lengths are the depths of the leaves
+		int longest = 0;
+		lengths.assign(weights.size(), 0);
+		for (size_t i = 0; i < weights.size(); i++)
+		{
+			if (weights[i] > 0)
+			{
+				for (size_t node = i; node != root; node = parents[node])
+				{
+					lengths[i]++;
+				}
+				longest = std::max(longest, lengths[i]);
+			}
+		}
+
+		// Flatten the frequencies until the code is short enough
+		if (longest <= maxLength)
+		{
+			break;
+		}
+		for (size_t i = 0; i < weights.size(); i++)
+		{
+			if (weights[i] > 0)
+			{
+				weights[i] = (weights[i] + 1) / 2;
+			}
+		}
+	}
+}
+
+// Build canonical Huffman codes from code lengths (bit-reversed, ready to be written least significant first)
+void Deflate::BuildCodes(const std::vector<int>& lengths, std::vector<uint32_t>& codes)
+{
+	int counts[16] = { 0 };
+	for (size_t i = 0; i < lengths.size(); i++)
+	{
+		counts[lengths[i]]++;
+	}
+	counts[0] = 0;
+
+	uint32_t next[16] = { 0 };
+	uint32_t code = 0;
+	for (int length = 1; length < 16; length++)
+	{
+		code = (code + counts[length - 1]) << 1;
+		next[length] = code;
+	}
+
+	codes.assign(lengths.size(), 0);
+	for (size_t i = 0; i < lengths.size(); i++)
+	{
+		int length = lengths[i];
+		if (length > 0)
+		{
+			uint32_t value = next[length]++;
+			uint32_t reversed = 0;
+			for (int bit = 0; bit < length; bit++)
+			{
+				reversed = (reversed << 1) | ((value >> bit) & 1);
+			}
+			codes[i] = reversed;
+		}
+	}
+}
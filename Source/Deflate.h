@@ -0,0 +1,81 @@
+// Deflate.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include "IllustratorSDK.h"
+#include <vector>
+
+namespace CanvasExport
+{
+	/// Streaming deflate (RFC 1951) compressor
+	/// Input is compressed as it arrives, using a 32KB window, so memory use doesn't depend on the size of the output
+	/// Each call to Compress writes one block with its own (dynamic) Huffman codes
+	class Deflate
+	{
+	private:
+
+		static const size_t		kWindowSize = 32768;		// How far back matches can reach
+		static const size_t		kMinMatch = 3;				// Shortest match
+		static const size_t		kMaxMatch = 258;			// Longest match
+		static const size_t		kHashBits = 15;				// Size of the hash table (in bits)
+		static const int		kMaxChain = 64;				// Most candidates tried for each match
+
+		/// A literal (distance is 0) or a match
+		struct Symbol
+		{
+			unsigned short		length;						// Literal byte, or length of the match
+			unsigned short		distance;					// Distance of the match
+		};
+
+		std::vector<unsigned char>	buffer;					// Window followed by input that hasn't been compressed
+		uint64_t				bufferStart;				// Stream position of the first byte in the buffer
+		uint64_t				position;					// Stream position of the next byte to compress
+		std::vector<int64_t>	head;						// Most recent stream position for each hash
+		std::vector<int64_t>	previous;					// Previous stream position with the same hash (indexed by position)
+		std::vector<Symbol>		symbols;					// Symbols of the current block
+		std::vector<uint32_t>	literalFrequencies;			// Literal/length frequencies of the current block
+		std::vector<uint32_t>	distanceFrequencies;		// Distance frequencies of the current block
+		uint64_t				bitBuffer;					// Bits that haven't been written
+		int						bitCount;					// Number of bits in the bit buffer
+
+		size_t					HashAt(uint64_t at) const;
+		void					Insert(uint64_t at);
+		size_t					FindMatch(uint64_t at, size_t available, size_t& distance);
+		void					WriteBlock(bool isFinal, std::string& out);
+		void					WriteBits(uint32_t value, int count, std::string& out);
+
+		static void				BuildLengths(const std::vector<uint32_t>& frequencies, int maxLength, std::vector<int>& lengths);
+		static void				BuildCodes(const std::vector<int>& lengths, std::vector<uint32_t>& codes);
+
+	public:
+
+		Deflate();
+		~Deflate();
+
+		void					Compress(const char* data, size_t size, bool isFinal, std::string& out);
+
+	};
+}
+
+#endif
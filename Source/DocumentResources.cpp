@@ -25,10 +25,26 @@
 
 using namespace CanvasExport;
 
-DocumentResources::DocumentResources()
+DocumentResources::DocumentResources(ExportContext& context)
 {
 	// Initialize DocumentResources
+	this->context = &context;
 	this->folderPath = "";
+	this->hasTemporaryArt = false;
+
+	// Everything that writes code uses the export context
+	this->images.context = &context;
+	this->rasterCache.context = &context;
+
+	// Collections allocate from the arena
+	this->images.arena = &this->arena;
+	this->patterns.arena = &this->arena;
+
+	// Font names are interned with the other state strings
+	this->fonts.strings = &this->strings;
+
+	// Traversals share the art properties
+	this->traversal.artInfo = &this->artInfo;
 }
 
 DocumentResources::~DocumentResources()
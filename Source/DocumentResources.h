@@ -25,15 +25,22 @@
 
 #include "IllustratorSDK.h"
 #include "Utility.h"
+#include "ExportContext.h"
+#include "Arena.h"
+#include "ArtTraversal.h"
+#include "ArtInfoCache.h"
+#include "ArtStyleCache.h"
 #include "ImageCollection.h"
 #include "PatternCollection.h"
+#include "RasterCache.h"
+#include "ColorCache.h"
+#include "StylePool.h"
+#include "StringTable.h"
+#include "FontCache.h"
+#include "GlyphCache.h"
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents the resources for a document
 	class DocumentResources
 	{
@@ -41,12 +48,25 @@ namespace CanvasExport
 
 	public:
 
-		DocumentResources();
+		DocumentResources(ExportContext& context);
 		~DocumentResources();
 
+		ExportContext*		context;					// Where the export is written
+		Arena				arena;						// Owns the export's layers, functions, canvases, images and patterns (declared first, so it's released last)
+		ArtTraversal		traversal;					// Walks art trees (its stacks are reused by every walk)
+		ArtInfoCache		artInfo;					// Art properties, queried once per export
+		ArtStyleCache		artStyles;					// Parsed art styles (by style handle)
+
 		ImageCollection		images;
 		PatternCollection	patterns;
+		RasterCache			rasterCache;				// Rasterized art kept between exports
+		ColorCache			colors;						// Converted colors and their CSS strings
+		StylePool			styles;						// Module-level style constants
+		StringTable			strings;					// Interned drawing state strings
+		FontCache			fonts;						// Font names and CSS font strings
+		GlyphCache			glyphs;						// Glyph outlines for text exported as geometry
 		std::string			folderPath;					// Path to output folder
+		AIBoolean			hasTemporaryArt;			// Was art added to the document while exporting? (undone when the export ends)
 
 	};
 }
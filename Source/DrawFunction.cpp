@@ -39,6 +39,8 @@ DrawFunction::DrawFunction()
 	this->followOrientation = 0.0f;
 	this->rasterizeFileName = "";
 	this->crop = false;
+	this->rasterDensities = 1;
+	this->textOutlines = false;
 }
 
 DrawFunction::~DrawFunction()
@@ -48,7 +50,7 @@ DrawFunction::~DrawFunction()
 void DrawFunction::RenderDrawFunctionCall(const AIRealRect& documentBounds)
 {
 	// New line
-	outFile << endl;
+	context->out << endl;
 	{
 		// No animation
 
@@ -56,28 +58,28 @@ void DrawFunction::RenderDrawFunctionCall(const AIRealRect& documentBounds)
 		if (translateOrigin)
 		{
 			// Save drawing context state
-			outFile << canvas->contextName << ".save();" << endl;
+			context->out << canvas->contextName << ".save();" << endl;
 
 			Reposition(documentBounds);
 		}
 
 		// Just call the function
-		outFile << name << "(" << canvas->contextName << ");" << endl;
+		context->out << name << "(" << canvas->contextName << ");" << endl;
 
 		// Show origin
-		if (debug)
+		if (context->debug)
 		{
-			outFile << canvas->contextName << ".save();" << endl;
-			outFile << canvas->contextName << ".fillStyle = \"rgb(0, 0, 255)\";" << endl;
-			outFile << canvas->contextName << ".fillRect(-2.0, -2.0, 5, 5);" << endl;
-			outFile << canvas->contextName << ".restore();" << endl;
+			context->out << canvas->contextName << ".save();" << endl;
+			context->out << canvas->contextName << ".fillStyle = \"rgb(0, 0, 255)\";" << endl;
+			context->out << canvas->contextName << ".fillRect(-2.0, -2.0, 5, 5);" << endl;
+			context->out << canvas->contextName << ".restore();" << endl;
 		}
 
 		// Do we need to restore?
 		if (translateOrigin)
 		{
 			// Restore drawing context state
-			outFile << canvas->contextName << ".restore();" << endl;
+			context->out << canvas->contextName << ".restore();" << endl;
 		}
 	}
 }
@@ -85,12 +87,18 @@ void DrawFunction::RenderDrawFunctionCall(const AIRealRect& documentBounds)
 // Render a drawing function
 void DrawFunction::RenderDrawFunction(const AIRealRect& documentBounds)
 {
-	outFile << "export const " << name << " = {" << endl;
+	// Attribute the function's output
+	if (context->report)
 	{
-		Indentation export_indentation(outFile);
+		context->report->Begin("function", name);
+	}
+
+	context->out << "export const " << name << " = {" << endl;
+	{
+		Indentation export_indentation(context->out);
 
 		// Layer bounds
-		outFile << "bounds: "
+		context->out << "bounds: "
 			<< "{ left: " << fixed << bounds.left
 			<< ", top: " << fixed << bounds.bottom
 			<< ", width: " << fixed << bounds.right - bounds.left
@@ -99,44 +107,50 @@ void DrawFunction::RenderDrawFunction(const AIRealRect& documentBounds)
 
 		const RenderMode renderMode = canvas->renderMode = isHitTest ? RM_HitTest : RM_Painter;
 
+		// Pixel densities for rasterized art
+		canvas->rasterDensities = rasterDensities;
+
+		// Text as glyph outlines
+		canvas->textOutlines = textOutlines;
+
 		if (renderMode == RM_HitTest)
 		{
 			// HitTest function
-			outFile << "containsPoint: (ctx: CanvasRenderingContext2D, x: number, y: number): boolean => {" << endl;
+			context->out << "containsPoint: (" << context->contextName << ": CanvasRenderingContext2D, x: number, y: number): boolean => {" << endl;
 		}
 		else
 		{
 			// Painter function
-			outFile << "paint: (ctx: CanvasRenderingContext2D) => {" << endl;
+			context->out << "paint: (" << context->contextName << ": CanvasRenderingContext2D) => {" << endl;
 		}
 
 		// Code block
 		{
-			Indentation paint_indentation(outFile);
+			Indentation paint_indentation(context->out);
 
 			//// Need a blank line?
 			//if (hasAlpha || hasGradients || hasPatterns)
 			//{
-			//	outFile << endl;
+			//	context->out << endl;
 			//}
 
 			// Does this draw function have alpha changes?
 			if (renderMode == RM_Painter && hasAlpha)
 			{
 				// Grab the alpha value (so we can use it to compute new globalAlpha values during this draw function)
-				outFile << "var alpha = ctx.globalAlpha;" << endl;
+				context->out << "var " << context->alphaName << " = " << context->contextName << ".globalAlpha;" << endl;
 			}
 
 			// Will we be encountering gradients?
 			if (renderMode == RM_Painter && hasGradients)
 			{
-				outFile << "var gradient: CanvasGradient;" << endl;
+				context->out << "var " << context->gradientName << ": CanvasGradient;" << endl;
 			}
 
 			// Will we be encountering patterns?
 			if (renderMode == RM_Painter && hasPatterns)
 			{
-				outFile << "var pattern: CanvasPattern;" << endl;
+				context->out << "var " << context->patternName << ": CanvasPattern;" << endl;
 			}
 
 			/// Re-set matrix based on document
@@ -168,9 +182,19 @@ void DrawFunction::RenderDrawFunction(const AIRealRect& documentBounds)
 					// TODO: Note that this only rasterizes the first associated layer. What if this has multiple layers?
 
 					// Output layer name
-					outFile << "// " << name;
+					context->out << "// " << name;
+
+					if (context->report)
+					{
+						context->report->Begin("layer", layers[0]->name);
+					}
 
 					canvas->RenderUnsupportedArt(layers[0]->artHandle, rasterizeFileName, 1);
+
+					if (context->report)
+					{
+						context->report->End();
+					}
 				}
 			}
 			else
@@ -178,24 +202,40 @@ void DrawFunction::RenderDrawFunction(const AIRealRect& documentBounds)
 				// Render each layer in the function block (they're already in the correct order)
 				for (unsigned int i = 0; i < layers.size(); i++)
 				{
+					// Attribute the layer's output
+					if (context->report)
+					{
+						context->report->Begin("layer", layers[i]->name);
+					}
+
 					// Render the art
 					canvas->RenderArt(layers[i]->artHandle, 1);
 
 					// Restore remaining state
 					canvas->SetContextDrawingState(1);
+
+					if (context->report)
+					{
+						context->report->End();
+					}
 				}
 			}
 
 			if (renderMode == RM_HitTest)
 			{
-				outFile << "return false;" << endl;
+				context->out << "return false;" << endl;
 			}
 		}
 
-		outFile << "}" << endl;
+		context->out << "}" << endl;
 	}
 
-	outFile << "};" << endl;
+	context->out << "};" << endl;
+
+	if (context->report)
+	{
+		context->report->End();
+	}
 }
 
 // Output repositioning translation for a draw function
@@ -215,7 +255,7 @@ void DrawFunction::Reposition(const AIRealRect& documentBounds)
 
 	// Render the repositioning translation for this function
 	// NOTE: This needs to happen, even if it's just "identity," since other functions may have already changed the transformation
-	outFile << canvas->contextName << ".translate(" << setiosflags(ios::fixed) << setprecision(1) << x << ", " << y << ");" << endl;
+	context->out << canvas->contextName << ".translate(" << setiosflags(ios::fixed) << setprecision(1) << x << ", " << y << ");" << endl;
 }
 
 void DrawFunction::SetParameter(const std::string& parameter, const std::string& value)
@@ -224,9 +264,9 @@ void DrawFunction::SetParameter(const std::string& parameter, const std::string&
 	if (parameter == "origin" ||
 		parameter == "o")
 	{
-		if (debug)
+		if (context->debug)
 		{
-			outFile << "//     Found origin parameter" << endl;
+			context->out << "//     Found origin parameter" << endl;
 		}
 
 		// Short-cut values?
@@ -291,9 +331,9 @@ void DrawFunction::SetParameter(const std::string& parameter, const std::string&
 				this->translateOriginH = (AIReal)strtod(originOffsets[0].c_str(), NULL);
 				this->translateOriginV = (AIReal)strtod(originOffsets[1].c_str(), NULL);
 
-				if (debug)
+				if (context->debug)
 				{
-					outFile << "//     translateH = " << setiosflags(ios::fixed) << setprecision(1) <<
+					context->out << "//     translateH = " << setiosflags(ios::fixed) << setprecision(1) <<
 						this->translateOriginH << ", translateV = " << this->translateOriginV << endl;
 				}
 			}
@@ -304,9 +344,9 @@ void DrawFunction::SetParameter(const std::string& parameter, const std::string&
 	if (parameter == "rasterize" ||
 		parameter == "rast")
 	{
-		if (debug)
+		if (context->debug)
 		{
-			outFile << "//     Found rasterize parameter" << endl;
+			context->out << "//     Found rasterize parameter" << endl;
 		}
 
 		if (value == "no" ||
@@ -336,9 +376,9 @@ void DrawFunction::SetParameter(const std::string& parameter, const std::string&
 				// Store file name
 				this->rasterizeFileName = fileName;
 
-				if (debug)
+				if (context->debug)
 				{
-					outFile << "//     Rasterize file name = " << fileName << endl;
+					context->out << "//     Rasterize file name = " << fileName << endl;
 				}
 			}
 		}
@@ -348,9 +388,9 @@ void DrawFunction::SetParameter(const std::string& parameter, const std::string&
 	if (parameter == "crop" ||
 		parameter == "c")
 	{
-		if (debug)
+		if (context->debug)
 		{
-			outFile << "//     Found crop parameter" << endl;
+			context->out << "//     Found crop parameter" << endl;
 		}
 
 		if (value == "yes" ||
@@ -375,13 +415,52 @@ void DrawFunction::SetParameter(const std::string& parameter, const std::string&
 		}
 	}
 
+	// Pixel densities
+	if (parameter == "dpr" ||
+		parameter == "d")
+	{
+		if (context->debug)
+		{
+			context->out << "//     Found dpr parameter" << endl;
+		}
+
+		// How many densities? (1 only writes the 1x image, 3 writes 1x, 2x and 3x)
+		int densities = atoi(value.c_str());
+		if (densities >= 1 && densities <= 3)
+		{
+			this->rasterDensities = densities;
+		}
+	}
+
+	// Text outlines
+	if (parameter == "outlines" ||
+		parameter == "ol")
+	{
+		if (context->debug)
+		{
+			context->out << "//     Found outlines parameter" << endl;
+		}
+
+		if (value == "no" ||
+			value == "n")
+		{
+			// Text uses fillText/strokeText (the viewer needs the fonts)
+			this->textOutlines = false;
+		}
+		else
+		{
+			// Text is drawn with cached glyph outlines
+			this->textOutlines = true;
+		}
+	}
+
 	// HitTest
 	if (parameter == "hit" ||
 		parameter == "h")
 	{
-		if (debug)
+		if (context->debug)
 		{
-			outFile << "//     Found hit parameter" << endl;
+			context->out << "//     Found hit parameter" << endl;
 		}
 
 		this->isHitTest = true;
@@ -48,6 +48,8 @@ namespace CanvasExport
 		AIReal				followOrientation;		// Follow orientation (in degrees)
 		std::string			rasterizeFileName;		// File name if this function is to be rasterized (empty if not)
 		bool				crop;					// Crop canvas to bounds of this drawing layer?
+		unsigned int		rasterDensities;		// Number of pixel densities (1x, 2x, ...) to rasterize fallback images at
+		bool				textOutlines;			// Export text as glyph outlines instead of fillText?
 
 		virtual void		SetParameter(const std::string& parameter, const std::string& value);
 
@@ -0,0 +1,91 @@
+// ExportContext.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "ExportContext.h"
+
+using namespace CanvasExport;
+
+ExportContext::ExportContext(std::ostream& sink)
+	: sink(sink)
+	, stream(sink)
+	, out(stream)
+{
+	// Initialize ExportContext
+	this->debug = false;
+	this->sourceMap = NULL;
+	this->report = NULL;
+	this->writer = NULL;
+	SetMinify(false);
+}
+
+ExportContext::~ExportContext()
+{
+}
+
+// Switch between readable and production code
+void ExportContext::SetMinify(bool minify)
+{
+	this->minify = minify;
+	stream.minify(minify);
+
+	// Local names
+	// NOTE: Minified names start with "$", so they can't shadow function names, and avoid the style and glyph constant prefixes
+	this->contextName = minify ? "$x" : "ctx";
+	this->alphaName = minify ? "$a" : "alpha";
+	this->gradientName = minify ? "$r" : "gradient";
+	this->patternName = minify ? "$p" : "pattern";
+}
+
+// Record where each line that's written comes from
+void ExportContext::SetSourceMap(SourceMap* sourceMap)
+{
+	this->sourceMap = sourceMap;
+	stream.mapLines(sourceMap ? &sourceMap->lines : NULL);
+}
+
+// Set the source of the lines that follow (-1 for none)
+void ExportContext::SetSource(int source)
+{
+	stream.source(source);
+}
+
+// Attribute each line that's written to the report's open scopes
+void ExportContext::SetReport(CostReport* report)
+{
+	this->report = report;
+	if (report)
+	{
+		stream.observeLines([report](const std::string& line, size_t indentation) { report->AddLine(line, indentation); });
+	}
+	else
+	{
+		stream.observeLines(nullptr);
+	}
+}
+
+// Write a line as is (it isn't indented, minified or mapped)
+void ExportContext::WriteLine(const std::string& line)
+{
+	// The indentation buffer doesn't hold anything back, so this follows what's been written
+	sink << line << endl;
+}
@@ -0,0 +1,69 @@
+// ExportContext.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef EXPORTCONTEXT_H
+#define EXPORTCONTEXT_H
+
+#include "IllustratorSDK.h"
+#include "IndentableStream.h"
+#include "FileWriter.h"
+#include "SourceMap.h"
+#include "CostReport.h"
+
+namespace CanvasExport
+{
+	/// Where an export writes its code and how it's configured
+	/// Everything that writes code is given the context of its export, so several exports can run at the same time,
+	/// and code can be written to any stream (e.g. a file or memory)
+	class ExportContext
+	{
+	private:
+
+		std::ostream&		sink;					// Where the file is written
+		IndentableStream	stream;					// Indents the code written to the sink
+
+	public:
+
+		ExportContext(std::ostream& sink);
+		~ExportContext();
+
+		void				SetMinify(bool minify);
+		void				SetSourceMap(SourceMap* sourceMap);
+		void				SetSource(int source);
+		void				SetReport(CostReport* report);
+		void				WriteLine(const std::string& line);
+
+		std::ostream&		out;					// Where code is written
+		bool				debug;					// Write debug information?
+		bool				minify;					// Write production code? (no comments, indentation or breadcrumbs, short local names)
+		const char*			contextName;			// Name of the drawing context in functions
+		const char*			alphaName;				// Name of the local holding a function's base alpha
+		const char*			gradientName;			// Name of the local holding the current gradient
+		const char*			patternName;			// Name of the local holding the current pattern
+		SourceMap*			sourceMap;				// Where lines come from (NULL if no source map is written)
+		CostReport*			report;					// Where output size and draw cost are attributed (NULL if no report is written)
+		FileWriter*			writer;					// Writes the sink to its file (NULL if the sink isn't a file writer)
+
+	};
+}
+
+#endif
@@ -0,0 +1,61 @@
+// FileWriter.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "FileWriter.h"
+
+using namespace CanvasExport;
+
+FileWriter::FileWriter()
+{
+	// Initialize FileWriter
+	this->copy = NULL;
+}
+
+FileWriter::~FileWriter()
+{
+}
+
+void FileWriter::SetCopy(FileWriter* copy)
+{
+	this->copy = copy;
+}
+
+FileWriter* FileWriter::GetCopy() const
+{
+	return copy;
+}
+
+// Time the export spent waiting on this writer and its copy
+double FileWriter::GetStallSeconds()
+{
+	return (copy ? copy->GetStallSeconds() : 0.0);
+}
+
+// Pass a written block on to the copy
+void FileWriter::CopyBlock(const char* data, size_t size)
+{
+	if (copy && size > 0)
+	{
+		copy->sputn(data, size);
+	}
+}
@@ -0,0 +1,68 @@
+// FileWriter.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef FILEWRITER_H
+#define FILEWRITER_H
+
+#include "IllustratorSDK.h"
+#include <streambuf>
+
+namespace CanvasExport
+{
+	// Represents the abstract base class for the sinks an export writes its file through
+	class FileWriter : public std::streambuf
+	{
+	private:
+
+		FileWriter*			copy;				// Writer that gets every block this writer publishes (if any)
+
+	protected:
+
+		// Pass a written block on to the copy
+		void				CopyBlock(const char* data, size_t size);
+
+	public:
+
+		FileWriter();
+		virtual ~FileWriter();
+
+		// Send every block that's written to another writer as well (e.g. to compress it)
+		void				SetCopy(FileWriter* copy);
+
+		// Writer that gets every block this writer publishes (if any)
+		FileWriter*			GetCopy() const;
+
+		// Open the file
+		virtual bool		Open(const std::string& path) = 0;
+
+		// Finish writing and close the file (returns false if anything couldn't be written)
+		virtual bool		Close() = 0;
+
+		// Time the export spent waiting on this writer and its copy
+		virtual double		GetStallSeconds();
+
+		// Report writer statistics
+		virtual void		DebugInfo(std::ostream& out) = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,113 @@
+// FontCache.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "FontCache.h"
+#include <sstream>
+
+using namespace CanvasExport;
+
+FontCache::FontCache()
+{
+	// Initialize FontCache
+	this->strings = NULL;
+	this->hits = 0;
+	this->misses = 0;
+}
+
+FontCache::~FontCache()
+{
+}
+
+bool FontCache::CSSFontKey::operator==(const CSSFontKey& other) const
+{
+	return fontName == other.fontName &&
+		fontStyleName == other.fontStyleName &&
+		fontSize == other.fontSize;
+}
+
+size_t FontCache::CSSFontKeyHash::operator()(const CSSFontKey& key) const
+{
+	// Combine the fields (boost::hash_combine style)
+	size_t seed = std::hash<unsigned int>()(key.fontName);
+	seed ^= std::hash<unsigned int>()(key.fontStyleName) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	seed ^= std::hash<AIReal>()(key.fontSize) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	return seed;
+}
+
+// Find the names of a font, returns false if it hasn't been looked up yet
+bool FontCache::Find(FontRef fontRef, unsigned int& fontName, unsigned int& fontStyleName)
+{
+	bool found = false;
+
+	// Look up the font
+	std::unordered_map<FontRef, FontNames>::const_iterator it = fonts.find(fontRef);
+	if (it != fonts.end())
+	{
+		// Found a match
+		fontName = it->second.fontName;
+		fontStyleName = it->second.fontStyleName;
+		found = true;
+		hits++;
+	}
+
+	return found;
+}
+
+// Remember the names of a font
+void FontCache::Add(FontRef fontRef, unsigned int fontName, unsigned int fontStyleName)
+{
+	FontNames names = { fontName, fontStyleName };
+	fonts[fontRef] = names;
+	misses++;
+}
+
+// Returns the CSS font string for a font and size (e.g. "Bold 12.0px 'Arial'")
+const std::string& FontCache::GetCSSFont(unsigned int fontName, unsigned int fontStyleName, AIReal fontSize)
+{
+	CSSFontKey key = { fontName, fontStyleName, fontSize };
+
+	// Have we formatted it already?
+	std::unordered_map<CSSFontKey, std::string, CSSFontKeyHash>::const_iterator it = cssFonts.find(key);
+	if (it != cssFonts.end())
+	{
+		return it->second;
+	}
+
+	// Format it
+	const std::string& styleName = strings->Get(fontStyleName);
+	std::ostringstream font;
+	font << "\"";
+	if (styleName != "Regular")
+	{
+		font << styleName << " ";
+	}
+	font << setiosflags(ios::fixed) << setprecision(1) << fontSize << "px '" << strings->Get(fontName) << "'\"";
+
+	return cssFonts[key] = font.str();
+}
+
+// Report cache statistics
+void FontCache::DebugInfo(std::ostream& out)
+{
+	out << "//   Fonts looked up = " << misses << ", cache hits = " << hits << ", CSS font strings = " << cssFonts.size() << endl;
+}
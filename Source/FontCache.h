@@ -0,0 +1,81 @@
+// FontCache.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef FONTCACHE_H
+#define FONTCACHE_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include "StringTable.h"
+#include <unordered_map>
+
+namespace CanvasExport
+{
+	/// Remembers resolved font names and CSS font strings, since text usually repeats a handful of fonts
+	class FontCache
+	{
+	private:
+
+		/// Interned names of a font
+		struct FontNames
+		{
+			unsigned int		fontName;			// System font name
+			unsigned int		fontStyleName;		// Style name
+		};
+
+		/// Identifies a CSS font string
+		struct CSSFontKey
+		{
+			unsigned int		fontName;			// Interned system font name
+			unsigned int		fontStyleName;		// Interned style name
+			AIReal				fontSize;			// Size (in pixels)
+
+			bool operator==(const CSSFontKey& other) const;
+		};
+
+		/// Hashes a CSSFontKey
+		struct CSSFontKeyHash
+		{
+			size_t operator()(const CSSFontKey& key) const;
+		};
+
+		std::unordered_map<FontRef, FontNames>	fonts;				// Font names (by font)
+		std::unordered_map<CSSFontKey, std::string, CSSFontKeyHash>	cssFonts;	// CSS font strings (by names and size)
+
+	public:
+
+		FontCache();
+		~FontCache();
+
+		StringTable*		strings;				// Table the names are interned in
+		unsigned int		hits;					// Fonts answered by the cache
+		unsigned int		misses;					// Fonts that had to be looked up
+
+		bool				Find(FontRef fontRef, unsigned int& fontName, unsigned int& fontStyleName);
+		void				Add(FontRef fontRef, unsigned int fontName, unsigned int fontStyleName);
+		const std::string&	GetCSSFont(unsigned int fontName, unsigned int fontStyleName, AIReal fontSize);
+		void				DebugInfo(std::ostream& out);
+
+	};
+}
+
+#endif
@@ -29,6 +29,7 @@ Function::Function()
 {
 	// Initialize Function
 	this->type = kAnyFunction;
+	this->context = NULL;
 	this->name = "";
 	this->canvas = NULL;
 	this->translateOrigin = false;
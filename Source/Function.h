@@ -42,6 +42,7 @@ namespace CanvasExport
 		~Function();
 
 		FunctionType		type;					// Type of this function (not very OO, but it works)
+		ExportContext*		context;				// Export this function is written to
 		std::string			name;					// Name of the function
 		Canvas*				canvas;					// Pointer to targeted canvas
 		AIRealRect			bounds;					// Bounds of the artwork
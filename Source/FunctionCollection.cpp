@@ -29,16 +29,14 @@ FunctionCollection::FunctionCollection()
 {
 	// Initialize FunctionCollection
 	this->hasDrawFunctions = false;
+	this->lastDrawFunction = 0;
+	this->arena = NULL;
+	this->context = NULL;
 }
 
 FunctionCollection::~FunctionCollection()
 {
-	// Clear functions
-	for (unsigned int i = 0; i < functions.size(); i++)
-	{
-		// Remove instance
-		delete functions[i];
-	}
+	// Instances are released with the arena
 }
 
 void FunctionCollection::RenderDrawFunctionCalls(const AIRealRect& documentBounds)
@@ -73,28 +71,18 @@ Function* FunctionCollection::Find(const std::string& name, const Function::Func
 {
 	Function* function = NULL;
 
-	// Any functions to search?
-	size_t i = functions.size();
-	if (i > 0)
+	// Look up the name (names are unique, so there's at most one function)
+	std::unordered_map<std::string, Function*>::const_iterator it = nameIndex.find(name);
+	if (it != nameIndex.end())
 	{
-		// Loop through functions
-		do
+		// Correct type?
+		if ((it->second->type == functionType) ||
+			(it->second->type == Function::kAnyFunction) ||
+			(functionType == Function::kAnyFunction))
 		{
-			i--;
-
-			// Correct type?
-			if ((functions[i]->type == functionType) ||
-				(functions[i]->type == Function::kAnyFunction))
-			{
-				// Do the names match?
-				if (functions[i]->name == name)
-				{
-					// Found a match
-					function = functions[i];
-					break;
-				}
-			}
-		} while (i > 0);
+			// Found a match
+			function = it->second;
+		}
 	}
 
 	// Return result
@@ -114,8 +102,9 @@ std::string FunctionCollection::CreateUniqueName(const std::string& name)
 	if (function)
 	{
 		// Find a unique name
+		// Continue where the last search for this name stopped, since all earlier suffixes are taken
 		std::ostringstream uniqueName;
-		int unique = 0;
+		int& unique = nextSuffix[usedName];
 		do
 		{
 			// Increment to make unique name
@@ -170,7 +159,8 @@ DrawFunction* FunctionCollection::AddDrawFunction(const std::string& name)
 	if (!drawFunction)
 	{
 		// Create a new function
-		drawFunction = new DrawFunction();
+		drawFunction = arena->Create<DrawFunction>();
+		drawFunction->context = context;
 
 		// Assign names
 		drawFunction->requestedName = name;
@@ -179,6 +169,12 @@ DrawFunction* FunctionCollection::AddDrawFunction(const std::string& name)
 		// Add function
 		functions.push_back(drawFunction);
 
+		// Index by name (and requested name, which FindDrawFunction also matches)
+		nameIndex[drawFunction->name] = drawFunction;
+		drawFunctionIndex[drawFunction->name] = functions.size() - 1;
+		drawFunctionIndex[drawFunction->requestedName] = functions.size() - 1;
+		lastDrawFunction = functions.size() - 1;
+
 		// Note that we have at least one draw function in the collection
 		hasDrawFunctions = true;
 	}
@@ -188,7 +184,7 @@ DrawFunction* FunctionCollection::AddDrawFunction(const std::string& name)
 }
 
 // Find a draw function
-// TODO: Any way we can clean this up? Seems a bit convoluted.
+// Matches the name or the requested name of the most recent draw function
 DrawFunction* FunctionCollection::FindDrawFunction(const std::string& name, bool& isLast)
 {
 	DrawFunction* drawFunction = NULL;
@@ -196,42 +192,15 @@ DrawFunction* FunctionCollection::FindDrawFunction(const std::string& name, bool
 	// By default
 	isLast = false;
 
-	// Track if we've seen a draw function yet
-	bool passedDrawFunction = false;
-
-	// Any functions to search?
-	size_t i = functions.size();
-	if (i > 0)
+	// Look up the most recent draw function with this name (or requested name)
+	std::unordered_map<std::string, size_t>::const_iterator it = drawFunctionIndex.find(name);
+	if (it != drawFunctionIndex.end())
 	{
-		// Loop through functions
-		do
-		{
-			i--;
+		// Found a match
+		drawFunction = (DrawFunction*)functions[it->second];
 
-			if (functions[i]->type == Function::kDrawFunction)
-			{
-				// Cast to DrawFunction
-				DrawFunction* searchDrawFunction = (DrawFunction*)functions[i];
-
-				// Do the names match?
-				if ((searchDrawFunction->name == name) ||
-					(searchDrawFunction->requestedName == name))
-				{
-					// Found a match
-					drawFunction = searchDrawFunction;
-					break;
-				}
-
-				// Can't be the last, if we've made it here
-				passedDrawFunction = true;
-			}
-		} while (i > 0);
-
-		// Did we find something AND it's the last draw function?
-		if (drawFunction && (!passedDrawFunction))
-		{
-			isLast = true;
-		}
+		// Is it the last draw function?
+		isLast = (it->second == lastDrawFunction);
 	}
 
 	// Return result
@@ -261,13 +230,13 @@ void FunctionCollection::DebugInfo()
 	}
 	
 	// Draw function debug info
-	outFile << "<p>Draw functions: " << drawFunctionCount << "</p>" << endl;
+	context->out << "<p>Draw functions: " << drawFunctionCount << "</p>" << endl;
 
 	// Anything to list?
 	if (drawFunctionCount > 0)
 	{
 		// Start unordered list
-		outFile << "<ul>" << endl;
+		context->out << "<ul>" << endl;
 
 		// Loop through each draw function
 		for (unsigned int i = 0; i < functions.size(); i++)
@@ -277,11 +246,11 @@ void FunctionCollection::DebugInfo()
 				// For convenience
 				DrawFunction* drawFunction = (DrawFunction*)functions[i];
 
-				outFile << "<li>name: " << drawFunction->name << ", layers: " << drawFunction->layers.size() << "</li>" << endl;
+				context->out << "<li>name: " << drawFunction->name << ", layers: " << drawFunction->layers.size() << "</li>" << endl;
 			}
 		}
 
 		// End unordered list
-		outFile << "</ul>" << endl;
+		context->out << "</ul>" << endl;
 	}
 }
\ No newline at end of file
@@ -24,27 +24,33 @@
 #define FUNCTIONCOLLECTION_H
 
 #include "IllustratorSDK.h"
+#include "Arena.h"
 #include "Function.h"
 #include "DrawFunction.h"
 #include "Utility.h"
+#include "ExportContext.h"
+#include <unordered_map>
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents a collection of functions
 	class FunctionCollection
 	{
 	private:
 		bool						hasDrawFunctions;		// Does the collection include at least one draw function?
+		std::unordered_map<std::string, Function*>	nameIndex;			// Functions (by name)
+		std::unordered_map<std::string, size_t>		drawFunctionIndex;	// Position of the most recent draw function (by name and requested name)
+		std::unordered_map<std::string, int>		nextSuffix;			// Last suffix tried by CreateUniqueName (by base name)
+		size_t						lastDrawFunction;		// Position of the most recent draw function
 
 	public:
 
 		FunctionCollection();
 		~FunctionCollection();
 
+		Arena*					arena;				// Arena that owns the functions
+		ExportContext*			context;			// Export the functions are written to
+
 		std::vector<Function*>		functions;				// Collection of functions
 
 		bool const					HasDrawFunctions();
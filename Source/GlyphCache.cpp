@@ -0,0 +1,107 @@
+// GlyphCache.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "GlyphCache.h"
+#include <sstream>
+
+using namespace CanvasExport;
+
+GlyphCache::GlyphCache()
+{
+	// Initialize GlyphCache
+	this->hits = 0;
+	this->misses = 0;
+}
+
+GlyphCache::~GlyphCache()
+{
+}
+
+bool GlyphCache::GlyphKey::operator==(const GlyphKey& other) const
+{
+	return fontName == other.fontName &&
+		fontStyleName == other.fontStyleName &&
+		glyphID == other.glyphID;
+}
+
+size_t GlyphCache::GlyphKeyHash::operator()(const GlyphKey& key) const
+{
+	// Combine the fields (boost::hash_combine style)
+	size_t seed = std::hash<unsigned int>()(key.fontName);
+	seed ^= std::hash<unsigned int>()(key.fontStyleName) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	seed ^= std::hash<unsigned int>()(key.glyphID) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	return seed;
+}
+
+// Returns the constant name of a glyph outline, or NULL if the glyph hasn't been outlined yet
+const std::string* GlyphCache::Find(unsigned int fontName, unsigned int fontStyleName, unsigned int glyphID)
+{
+	GlyphKey key = { fontName, fontStyleName, glyphID };
+
+	// Look up the glyph
+	std::unordered_map<GlyphKey, std::string, GlyphKeyHash>::const_iterator it = names.find(key);
+	if (it != names.end())
+	{
+		hits++;
+		return &it->second;
+	}
+
+	return NULL;
+}
+
+// Adds a glyph outline (SVG path data in font units), and returns its constant name
+// NOTE: Names start with "$", which never appears in function names
+const std::string& GlyphCache::Add(unsigned int fontName, unsigned int fontStyleName, unsigned int glyphID, const std::string& data)
+{
+	GlyphKey key = { fontName, fontStyleName, glyphID };
+
+	// Create a new constant
+	std::ostringstream name;
+	name << "$g" << constantNames.size();
+	constantNames.push_back(name.str());
+	pathData.push_back(data);
+	misses++;
+
+	return names[key] = name.str();
+}
+
+// Render the glyph constants
+// NOTE: Drawing code only runs after the module has been evaluated, so the constants can follow the functions that use them
+void GlyphCache::Render(std::ostream& out)
+{
+	// Anything to render?
+	if (!constantNames.empty())
+	{
+		out << endl;
+		for (size_t i = 0; i < constantNames.size(); i++)
+		{
+			out << "const " << constantNames[i] << " = new Path2D(\"" << pathData[i] << "\");" << endl;
+		}
+	}
+}
+
+// Report cache statistics
+void GlyphCache::DebugInfo(std::ostream& out)
+{
+	out << "//   Glyphs outlined = " << misses << ", cache hits = " << hits << endl;
+}
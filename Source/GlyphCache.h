@@ -0,0 +1,74 @@
+// GlyphCache.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include <unordered_map>
+
+namespace CanvasExport
+{
+	/// Collects glyph outlines (in font units) as module-level Path2D constants, so text exported as geometry
+	/// only describes each glyph of a font once
+	class GlyphCache
+	{
+	private:
+
+		/// Identifies a glyph of a font
+		struct GlyphKey
+		{
+			unsigned int		fontName;			// Interned system font name
+			unsigned int		fontStyleName;		// Interned style name
+			unsigned int		glyphID;			// Glyph within the font
+
+			bool operator==(const GlyphKey& other) const;
+		};
+
+		/// Hashes a GlyphKey
+		struct GlyphKeyHash
+		{
+			size_t operator()(const GlyphKey& key) const;
+		};
+
+		std::unordered_map<GlyphKey, std::string, GlyphKeyHash>	names;	// Constant names (by glyph)
+		std::vector<std::string>	constantNames;		// Constant names (in order of first use)
+		std::vector<std::string>	pathData;			// SVG path data (in order of first use)
+
+	public:
+
+		GlyphCache();
+		~GlyphCache();
+
+		unsigned int		hits;					// Glyphs answered by the cache
+		unsigned int		misses;					// Glyphs that had to be outlined
+
+		const std::string*	Find(unsigned int fontName, unsigned int fontStyleName, unsigned int glyphID);
+		const std::string&	Add(unsigned int fontName, unsigned int fontStyleName, unsigned int glyphID, const std::string& data);
+		void				Render(std::ostream& out);
+		void				DebugInfo(std::ostream& out);
+
+	};
+}
+
+#endif
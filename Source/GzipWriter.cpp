@@ -0,0 +1,122 @@
+// GzipWriter.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "GzipWriter.h"
+
+using namespace CanvasExport;
+
+// Build the CRC-32 lookup table
+static std::vector<uint32_t> BuildCrcTable()
+{
+	std::vector<uint32_t> table(256);
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t c = i;
+		for (int bit = 0; bit < 8; bit++)
+		{
+			c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+		}
+		table[i] = c;
+	}
+	return table;
+}
+
+// Update a CRC-32 (as used by gzip)
+static uint32_t UpdateCrc(uint32_t crc, const char* data, size_t size)
+{
+	static const std::vector<uint32_t> table = BuildCrcTable();
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++)
+	{
+		crc = table[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+GzipWriter::GzipWriter()
+{
+	// Initialize GzipWriter
+	this->crc = 0;
+	this->uncompressedSize = 0;
+	this->compressedCount = 0;
+	this->openMode = ios::out | ios::binary;
+}
+
+GzipWriter::~GzipWriter()
+{
+	// Finish before the writer thread loses its compressor
+	Close();
+}
+
+// Open the compressed file
+bool GzipWriter::Open(const std::string& path)
+{
+	// gzip header (RFC 1952): deflate, no name or time, unknown OS (written with the first block)
+	const char header[10] = { '\x1F', '\x8B', 8, 0, 0, 0, 0, 0, 0, '\xFF' };
+	compressed.assign(header, sizeof(header));
+	compressedCount = 0;
+	crc = 0;
+	uncompressedSize = 0;
+
+	return AsyncWriter::Open(path);
+}
+
+// Compress a block (called on the writer thread)
+void GzipWriter::WriteBlock(const char* data, size_t size)
+{
+	crc = UpdateCrc(crc, data, size);
+	uncompressedSize += (uint32_t)size;
+
+	deflate.Compress(data, size, false, compressed);
+	AsyncWriter::WriteBlock(compressed.data(), compressed.size());
+	compressedCount += compressed.size();
+	compressed.clear();
+}
+
+// Finish the compressed stream (called on the writer thread)
+void GzipWriter::Finish()
+{
+	deflate.Compress(NULL, 0, true, compressed);
+
+	// gzip trailer: CRC-32 and size (little-endian)
+	for (int i = 0; i < 4; i++)
+	{
+		compressed.push_back((char)(crc >> (i * 8)));
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		compressed.push_back((char)(uncompressedSize >> (i * 8)));
+	}
+
+	AsyncWriter::WriteBlock(compressed.data(), compressed.size());
+	compressedCount += compressed.size();
+	compressed.clear();
+}
+
+// Report writer statistics
+void GzipWriter::DebugInfo(std::ostream& out)
+{
+	AsyncWriter::DebugInfo(out);
+	out << "//   Compressed bytes = " << compressedCount << endl;
+}
@@ -0,0 +1,61 @@
+// GzipWriter.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef GZIPWRITER_H
+#define GZIPWRITER_H
+
+#include "IllustratorSDK.h"
+#include "AsyncWriter.h"
+#include "Deflate.h"
+
+namespace CanvasExport
+{
+	/// Output sink that writes a gzip-compressed copy of the export beside the plain file
+	/// It's set as the plain file writer's copy, so it gets each block the plain writer publishes, and compresses it on
+	/// the writer thread, so the export doesn't pay for compression
+	class GzipWriter : public AsyncWriter
+	{
+	private:
+
+		Deflate					deflate;				// Compressor (only used by the writer thread)
+		std::string				compressed;				// Compressed bytes that haven't been written (only used by the writer thread)
+		uint32_t				crc;					// CRC-32 of the uncompressed bytes (only used by the writer thread)
+		uint32_t				uncompressedSize;		// Number of uncompressed bytes (modulo 2^32, only used by the writer thread)
+		std::atomic<uint64_t>	compressedCount;		// Number of compressed bytes written
+
+	protected:
+
+		void					WriteBlock(const char* data, size_t size) override;
+		void					Finish() override;
+
+	public:
+
+		GzipWriter();
+		~GzipWriter();
+
+		bool					Open(const std::string& path) override;
+		void					DebugInfo(std::ostream& out) override;
+
+	};
+}
+
+#endif
@@ -0,0 +1,106 @@
+// Hash.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "Hash.h"
+
+using namespace CanvasExport;
+
+// FNV-1a constants (see http://www.isthe.com/chongo/tech/comp/fnv/)
+static const uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+static const uint64_t kFNVPrime = 1099511628211ULL;
+
+Hash::Hash()
+{
+	// Initialize Hash
+	this->value = kFNVOffsetBasis;
+}
+
+Hash::~Hash()
+{
+}
+
+// Add raw bytes
+void Hash::Add(const void* data, size_t length)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < length; i++)
+	{
+		value ^= bytes[i];
+		value *= kFNVPrime;
+	}
+}
+
+// Add a string (including its length, so "ab" + "c" differs from "a" + "bc")
+void Hash::Add(const std::string& s)
+{
+	Add((int)s.length());
+	Add(s.data(), s.length());
+}
+
+// Add an integer (in a fixed byte order, so the hash is the same on every platform)
+void Hash::Add(int i)
+{
+	unsigned char bytes[4];
+	bytes[0] = (unsigned char)(i & 0xff);
+	bytes[1] = (unsigned char)((i >> 8) & 0xff);
+	bytes[2] = (unsigned char)((i >> 16) & 0xff);
+	bytes[3] = (unsigned char)((i >> 24) & 0xff);
+	Add(bytes, sizeof(bytes));
+}
+
+// Add a real value
+// NOTE: Values are quantized to 1/1000, which hides floating point noise (and -0.0) between sessions
+void Hash::Add(AIReal r)
+{
+	long long quantized = (long long)floor((r * 1000.0) + 0.5);
+	Add((int)(quantized & 0xffffffff));
+	Add((int)(quantized >> 32));
+}
+
+// Add the content of a file, returns false if it can't be read
+bool Hash::AddFile(const std::string& path)
+{
+	// Open the file
+	std::ifstream file(path.c_str(), ios::in | ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// Hash it in blocks
+	char buffer[64 * 1024];
+	while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+	{
+		Add(buffer, (size_t)file.gcount());
+	}
+
+	return true;
+}
+
+// Hash value as 16 hexadecimal digits
+std::string Hash::ToString() const
+{
+	std::ostringstream hex;
+	hex << std::hex << std::setfill('0') << std::setw(16) << value;
+	return hex.str();
+}
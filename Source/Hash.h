@@ -0,0 +1,53 @@
+// Hash.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef HASH_H
+#define HASH_H
+
+#include "IllustratorSDK.h"
+#include <fstream>
+
+namespace CanvasExport
+{
+	/// Accumulates a 64-bit FNV-1a hash, used to derive stable keys from content
+	class Hash
+	{
+	private:
+
+	public:
+
+		Hash();
+		~Hash();
+
+		uint64_t				value;				// Current hash value
+
+		void					Add(const void* data, size_t length);
+		void					Add(const std::string& s);
+		void					Add(int i);
+		void					Add(AIReal r);
+		bool					AddFile(const std::string& path);
+		std::string				ToString() const;
+
+	};
+}
+
+#endif
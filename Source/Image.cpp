@@ -28,10 +28,14 @@ using namespace CanvasExport;
 Image::Image(const std::string& id, const std::string& path)
 {
 	// Initialize Image
+	this->context = NULL;
 	this->id = id;
 	this->path = path;
 	this->name = "";
 	this->pathIsAbsolute = false;
+	this->sourceKey = "";
+	this->width = 0;
+	this->height = 0;
 }
 
 Image::~Image()
@@ -41,10 +45,15 @@ Image::~Image()
 void Image::Render()
 {
 	// Output image tag
-	outFile << "<img alt=\"" << name << "\" id=\"" << id << "\" style=\"display: none\" src=\"" << Uri() << "\" />" << endl;
+	context->out << "<img alt=\"" << name << "\" id=\"" << id << "\" style=\"display: none\" src=\"" << Uri() << "\" />" << endl;
 }
 
 std::string Image::Uri()
+{
+	return Uri(path);
+}
+
+std::string Image::Uri(const std::string& path)
 {
 	// Create file URI
 	ai::UnicodeString usPath(path);
@@ -70,23 +79,45 @@ std::string Image::Uri()
 
 void Image::RenderDrawImage(const std::string& contextName, const AIReal x, const AIReal y)
 {
-	// Draw image
-	outFile  << contextName << ".drawImage(document.getElementById(\"" << id << "\"), " <<
-		setiosflags(ios::fixed) << setprecision(1) <<
-		x << ", " << y << ");" << endl;
+	// Do we have higher density variants?
+	if (variants.empty())
+	{
+		// Draw image
+		context->out  << contextName << ".drawImage(document.getElementById(\"" << id << "\"), " <<
+			setiosflags(ios::fixed) << setprecision(1) <<
+			x << ", " << y << ");" << endl;
+	}
+	else
+	{
+		// Let the selector pick a variant, and draw it at the 1x size
+		context->out  << contextName << ".drawImage(selectImage(" << contextName << ", \"" << id << "\", [";
+		for (unsigned int i = 0; i < variants.size(); i++)
+		{
+			context->out << (i > 0 ? ", " : "") << "\"" << Uri(variants[i]) << "\"";
+		}
+		context->out << "]), " <<
+			setiosflags(ios::fixed) << setprecision(1) <<
+			x << ", " << y << ", " << width << ", " << height << ");" << endl;
+	}
+
+	// Attribute the image's files and pixels
+	if (context->report)
+	{
+		context->report->AddImage(path, pathIsAbsolute, variants, width, height);
+	}
 }
 
 void Image::DebugBounds(const std::string& contextName, const AIRealRect& bounds)
 {
-	if (debug)
+	if (context->debug)
 	{
 		// Stroke bounds	
-		outFile  << contextName << ".save();" << endl;
-		outFile  << contextName << ".lineWidth = 1.0;" << endl;
-		outFile  << contextName << ".strokeStyle = \"rgb(255, 0, 0)\";" << endl;
-		outFile  << contextName << ".strokeRect(" <<
+		context->out  << contextName << ".save();" << endl;
+		context->out  << contextName << ".lineWidth = 1.0;" << endl;
+		context->out  << contextName << ".strokeStyle = \"rgb(255, 0, 0)\";" << endl;
+		context->out  << contextName << ".strokeRect(" <<
 			setiosflags(ios::fixed) << setprecision(1) <<
 			bounds.left << ", " << bounds.top << ", " << (bounds.right - bounds.left) << ", " << (bounds.bottom - bounds.top) << ");" << endl;
-		outFile  << contextName << ".restore();" << endl;
+		context->out  << contextName << ".restore();" << endl;
 	}
 }
\ No newline at end of file
@@ -25,13 +25,10 @@
 
 #include "IllustratorSDK.h"
 #include "Utility.h"
+#include "ExportContext.h"
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents a bitmap image
 	class Image
 	{
@@ -43,15 +40,21 @@ namespace CanvasExport
 		Image(const std::string& id, const std::string& path);		
 		~Image();
 
+		ExportContext*			context;			// Export this image is drawn in
 		std::string				id;					// Image element ID
 		std::string				path;				// File path to the image
 		std::string				name;				// Name of the image (to be used for the alt attribute)
 		bool					pathIsAbsolute;		// Is this an absolute image path?
+		std::string				sourceKey;			// Identifies the raster source this image was made from (empty if not shareable)
+		unsigned int			width;				// Width of the image file (in pixels, 0 if unknown)
+		unsigned int			height;				// Height of the image file (in pixels, 0 if unknown)
+		std::vector<std::string>	variants;		// File paths to 2x, 3x, ... pixel density variants (empty if none)
 
 		void					Render();
 		void					RenderDrawImage(const std::string& contextName, const AIReal x, const AIReal y);
 		void					DebugBounds(const std::string& contextName, const AIRealRect& bounds);
 		std::string				Uri();
+		std::string				Uri(const std::string& path);
 
 	};
 }
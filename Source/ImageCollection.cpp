@@ -22,21 +22,20 @@
 
 #include "IllustratorSDK.h"
 #include "ImageCollection.h"
+#include "IndentableStream.h"
 
 using namespace CanvasExport;
 
 ImageCollection::ImageCollection()
 {
+	// Initialize ImageCollection
+	this->arena = NULL;
+	this->context = NULL;
 }
 
 ImageCollection::~ImageCollection()
 {
-	// Clear images
-	for (unsigned int i = 0; i < images.size(); i++)
-	{
-		// Remove instance
-		delete images[i];
-	}
+	// Instances are released with the arena
 }
 
 void ImageCollection::Render()
@@ -63,10 +62,14 @@ Image* ImageCollection::Add(const std::string& path)
 		id << "image" << (images.size() + 1);
 
 		// Create a new image
-		image = new Image(id.str(), path);
+		image = arena->Create<Image>(id.str(), path);
+		image->context = context;
 
 		// Add to document
 		images.push_back(image);
+
+		// Index by path
+		pathIndex[path] = image;
 	}
 
 	// Return result
@@ -78,41 +81,157 @@ Image* ImageCollection::Find(const std::string& path)
 {
 	Image* result = NULL;
 
+	// Look up the path
+	std::unordered_map<std::string, Image*>::const_iterator it = pathIndex.find(path);
+	if (it != pathIndex.end())
+	{
+		// Found a match
+		result = it->second;
+	}
+
+	// Return result
+	return result;
+}
+
+// Find an image by the raster source it was made from, returns NULL if not found
+Image* ImageCollection::FindSource(const std::string& sourceKey)
+{
+	Image* result = NULL;
+
+	// Look up the source
+	std::unordered_map<std::string, Image*>::const_iterator it = sourceIndex.find(sourceKey);
+	if (it != sourceIndex.end())
+	{
+		// Found a match
+		result = it->second;
+	}
+
+	// Return result
+	return result;
+}
+
+// Remember the raster source an image was made from (so FindSource can find it)
+void ImageCollection::SetSource(Image* image, const std::string& sourceKey)
+{
+	image->sourceKey = sourceKey;
+	sourceIndex[sourceKey] = image;
+}
+
+// Do any images have higher pixel density variants?
+bool ImageCollection::HasVariants()
+{
+	bool result = false;
+
 	// Loop through images
 	for (unsigned int i = 0; i < images.size(); i++)
 	{
-		// Do the paths match?
-		if (images[i]->path == path)
+		if (!images[i]->variants.empty())
 		{
-			// Found a match
-			result = images[i];
+			result = true;
 			break;
 		}
 	}
 
-	// Return result
 	return result;
 }
 
+// Render the function that picks an image variant for the current pixel density
+// NOTE: The 1x image is the document element, while 2x/3x variants are only requested (and decoded) once a context
+//       with that density draws them. Until a variant has loaded, the 1x image is drawn instead.
+void ImageCollection::RenderSelectImage()
+{
+	context->out << endl;
+	context->out << "const imageVariants: { [src: string]: HTMLImageElement } = {};" << endl;
+	context->out << endl;
+	context->out << "function selectImage(ctx: CanvasRenderingContext2D, id: string, variants: string[]): HTMLImageElement {" << endl;
+	{
+		Indentation function_indentation(context->out);
+
+		context->out << "const image = document.getElementById(id) as HTMLImageElement;" << endl;
+		context->out << endl;
+		context->out << "// Device pixels per image pixel (a canvas scaled for the screen already has its density in the transform)" << endl;
+		context->out << "const m = ctx.getTransform();" << endl;
+		context->out << "const transformScale = Math.sqrt(Math.abs(m.a * m.d - m.b * m.c));" << endl;
+		context->out << "const scale = (Math.abs(transformScale - 1) > 0.01) ? transformScale : (window.devicePixelRatio || 1);" << endl;
+		context->out << "const index = Math.min(Math.ceil(scale - 0.05), variants.length + 1) - 2;" << endl;
+		context->out << "if (index < 0) {" << endl;
+		{
+			Indentation if_indentation(context->out);
+			context->out << "return image;" << endl;
+		}
+		context->out << "}" << endl;
+		context->out << endl;
+		context->out << "// Load the variant on first use" << endl;
+		context->out << "let variant = imageVariants[variants[index]];" << endl;
+		context->out << "if (!variant) {" << endl;
+		{
+			Indentation if_indentation(context->out);
+			context->out << "variant = new Image();" << endl;
+			context->out << "variant.src = variants[index];" << endl;
+			context->out << "imageVariants[variants[index]] = variant;" << endl;
+		}
+		context->out << "}" << endl;
+		context->out << "return (variant.complete && variant.naturalWidth > 0) ? variant : image;" << endl;
+	}
+	context->out << "}" << endl;
+}
+
+// Write a JSON manifest that maps image IDs (as used by the drawing code) to their files
+bool ImageCollection::WriteManifest(const std::string& path)
+{
+	// Open the manifest file
+	std::ofstream manifestFile(path.c_str(), ios::out | ios::trunc);
+	if (!manifestFile.is_open())
+	{
+		return false;
+	}
+
+	manifestFile << "{" << endl;
+	manifestFile << "  \"images\": {";
+
+	// Loop through images
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		Image* image = images[i];
+		manifestFile << (i > 0 ? "," : "") << endl;
+		manifestFile << "    \"" << EscapeJSON(image->id) << "\": { " <<
+			"\"file\": \"" << EscapeJSON(image->Uri()) << "\", " <<
+			"\"name\": \"" << EscapeJSON(image->name) << "\", " <<
+			"\"width\": " << image->width << ", " <<
+			"\"height\": " << image->height << ", " <<
+			"\"variants\": [";
+		for (unsigned int j = 0; j < image->variants.size(); j++)
+		{
+			manifestFile << (j > 0 ? ", " : "") << "\"" << EscapeJSON(image->Uri(image->variants[j])) << "\"";
+		}
+		manifestFile << "] }";
+	}
+
+	manifestFile << endl << "  }" << endl;
+	manifestFile << "}" << endl;
+
+	return !manifestFile.fail();
+}
+
 void ImageCollection::DebugInfo()
 {
 	// Image debug info
-	outFile << "<p>Bitmap images: " << images.size() << "</p>" << endl;
+	context->out << "<p>Bitmap images: " << images.size() << "</p>" << endl;
 
 	// Anything to list?
 	if (images.size() > 0)
 	{
 		// Start unordered list
-		outFile << "<ul>" << endl;
+		context->out << "<ul>" << endl;
 
 		// Loop through each image
 		for (unsigned int i = 0; i < images.size(); i++)
 		{
-			outFile << "<li>ID: " << images[i]->id <<
+			context->out << "<li>ID: " << images[i]->id <<
 						 ", path: <a href=\"" << images[i]->Uri() << "\" target=\"_blank\">" << images[i]->path << "</a></li>" << endl;
 		}
 
 		// End unordered list
-		outFile << "</ul>" << endl;
+		context->out << "</ul>" << endl;
 	}
 }
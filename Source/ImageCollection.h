@@ -24,30 +24,38 @@
 #define IMAGECOLLECTION_H
 
 #include "IllustratorSDK.h"
+#include "Arena.h"
 #include "Image.h"
 #include "Utility.h"
+#include <unordered_map>
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents a collection of images
 	class ImageCollection
 	{
 	private:
 
 		std::vector<Image*>		images;				// Collection of image pointers
+		std::unordered_map<std::string, Image*>	pathIndex;		// Images (by path)
+		std::unordered_map<std::string, Image*>	sourceIndex;	// Images (by raster source key)
 
 	public:
 
 		ImageCollection();
 		~ImageCollection();
 
+		Arena*					arena;				// Arena that owns the images
+		ExportContext*			context;			// Export the images are drawn in
+
 		void					Render();
 		Image*					Add(const std::string& path);
 		Image*					Find(const std::string& path);
+		Image*					FindSource(const std::string& sourceKey);
+		void					SetSource(Image* image, const std::string& sourceKey);
+		bool					HasVariants();
+		void					RenderSelectImage();
+		bool					WriteManifest(const std::string& path);
 		void					DebugInfo();
 
 	};
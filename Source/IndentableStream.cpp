@@ -29,6 +29,12 @@ namespace CanvasExport
 		: m_streamBuffer(sbuf)
 		, m_indentationLevel(0)
 		, m_shouldIndent(true)
+		, m_minify(false)
+		, m_pendingSlash(false)
+		, m_skipLine(false)
+		, m_mapLines(nullptr)
+		, m_source(-1)
+		, m_lineIndentation(0)
 	{
 	}
 
@@ -37,19 +43,89 @@ namespace CanvasExport
 		if (traits_type::eq_int_type(c, traits_type::eof()))
 			return m_streamBuffer->sputc(char(c));
 
+		if (m_minify)
+		{
+			// Drop the rest of a comment line (including its newline)
+			if (m_skipLine)
+			{
+				if (traits_type::eq_int_type(c, traits_type::to_char_type('\n')))
+				{
+					m_skipLine = false;
+				}
+				return traits_type::not_eof(c);
+			}
+
+			// A line that starts with "//" is a comment (code never starts a line with it)
+			if (m_pendingSlash)
+			{
+				m_pendingSlash = false;
+				if (traits_type::eq_int_type(c, traits_type::to_char_type('/')))
+				{
+					m_skipLine = true;
+					return traits_type::not_eof(c);
+				}
+				if (!put('/'))
+					return traits_type::eof();
+			}
+			else if (m_shouldIndent)
+			{
+				// Drop blank lines, and hold on to a slash until we know what it starts
+				if (traits_type::eq_int_type(c, traits_type::to_char_type('\n')))
+					return traits_type::not_eof(c);
+
+				if (traits_type::eq_int_type(c, traits_type::to_char_type('/')))
+				{
+					m_pendingSlash = true;
+					return traits_type::not_eof(c);
+				}
+			}
+		}
+
+		if (!put(char(c)))
+			return traits_type::eof();
+
+		return traits_type::not_eof(c);
+	}
+
+	bool IndentationBuffer::put(const char c)
+	{
+		// Remember where each line came from
+		if (m_shouldIndent && m_mapLines)
+		{
+			m_mapLines->push_back(m_source);
+		}
+
+		// Collect the line for the observer
+		if (m_lineObserver)
+		{
+			if (m_shouldIndent)
+			{
+				m_lineIndentation = m_minify ? 0 : m_indentationLevel * 2;
+			}
+			if (c == '\n')
+			{
+				m_lineObserver(m_line, m_lineIndentation);
+				m_line.clear();
+			}
+			else
+			{
+				m_line.push_back(c);
+			}
+		}
+
 		if (m_shouldIndent)
 		{
-			fill_n(std::ostreambuf_iterator<char>(m_streamBuffer), m_indentationLevel * 2, ' ');
+			if (!m_minify)
+				fill_n(std::ostreambuf_iterator<char>(m_streamBuffer), m_indentationLevel * 2, ' ');
 			m_shouldIndent = false;
 		}
 
-		if (traits_type::eq_int_type(m_streamBuffer->sputc(char(c)), traits_type::eof()))
-			return traits_type::eof();
+		if (traits_type::eq_int_type(m_streamBuffer->sputc(c), traits_type::eof()))
+			return false;
 
-		if (traits_type::eq_int_type(c, traits_type::to_char_type('\n')))
+		if (c == '\n')
 			m_shouldIndent = true;
 
-		return traits_type::not_eof(c);
+		return true;
 	}
-
-}
\ No newline at end of file
+}
@@ -23,8 +23,11 @@
 #ifndef INDENTABLESTREAM_H
 #define INDENTABLESTREAM_H
 
+#include <functional>
 #include <streambuf>
 #include <ostream>
+#include <string>
+#include <vector>
 
 namespace CanvasExport
 {
@@ -39,13 +42,35 @@ namespace CanvasExport
 
 		void undent() { m_indentationLevel = max(0, m_indentationLevel - 1); }
 
+		// Record the source of each line that's written (nullptr to stop)
+		void mapLines(std::vector<int>* lines) { m_mapLines = lines; }
+
+		// Set the source of the lines that follow (-1 for none)
+		void source(int source) { m_source = source; }
+
+		// Leave out indentation, blank lines and comment lines
+		void minify(bool minify) { m_minify = minify; }
+
+		// Pass each line that's written (without its newline) and its indentation to an observer (empty to stop)
+		void observeLines(const std::function<void(const std::string&, size_t)>& observer) { m_lineObserver = observer; }
+
 	protected:
 
 		int_type overflow(int_type c) override;
 
+		bool put(char c);
+
 		std::streambuf* m_streamBuffer;
 		int m_indentationLevel;
 		bool m_shouldIndent;
+		bool m_minify;
+		bool m_pendingSlash;
+		bool m_skipLine;
+		std::vector<int>* m_mapLines;
+		int m_source;
+		std::function<void(const std::string&, size_t)> m_lineObserver;
+		std::string m_line;
+		size_t m_lineIndentation;
 	};
 
 	class IndentableStream : public std::ostream
@@ -83,6 +108,14 @@ namespace CanvasExport
 
 		size_t itemsPerLine() const { return m_itemsPerLine; }
 
+		void mapLines(std::vector<int>* lines) { m_indentationBuffer.mapLines(lines); }
+
+		void source(int source) { m_indentationBuffer.source(source); }
+
+		void minify(bool minify) { m_indentationBuffer.minify(minify); }
+
+		void observeLines(const std::function<void(const std::string&, size_t)>& observer) { m_indentationBuffer.observeLines(observer); }
+
 	private:
 		IndentationBuffer m_indentationBuffer;
 		size_t m_itemsPerLine;
@@ -52,18 +52,18 @@ Layer::~Layer()
 // ******************** GLOBAL FUNCTIONS ********************
 
 // Add a new layer
-Layer* CanvasExport::AddLayer(std::vector<Layer*>& layers, const AILayerHandle& layerHandle)
+Layer* CanvasExport::AddLayer(std::vector<Layer*>& layers, const AILayerHandle& layerHandle, Arena& arena, ExportContext& context)
 {
 	// Get layer name
 	ai::UnicodeString layerName;
 	sAILayer->GetLayerTitle(layerHandle, layerName);
-	if (debug)
+	if (context.debug)
 	{
-		outFile << "//   Layer name = " << layerName.as_Platform() << endl;
+		context.out << "//   Layer name = " << layerName.as_Platform() << endl;
 	}
 
 	// Create a new layer
-	Layer* layer = new Layer();
+	Layer* layer = arena.Create<Layer>();
 	
 	// Set values
 	layer->layerHandle = layerHandle;
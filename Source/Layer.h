@@ -25,13 +25,11 @@
 
 #include "IllustratorSDK.h"
 #include "Utility.h"
+#include "Arena.h"
+#include "ExportContext.h"
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents a layer
 	class Layer
 	{
@@ -53,6 +51,6 @@ namespace CanvasExport
 	};
 
 	// Global functions
-	Layer* AddLayer(std::vector<Layer*>& layers, const AILayerHandle& layerHandle);
+	Layer* AddLayer(std::vector<Layer*>& layers, const AILayerHandle& layerHandle, Arena& arena, ExportContext& context);
 }
 #endif
\ No newline at end of file
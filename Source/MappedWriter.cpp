@@ -0,0 +1,305 @@
+// MappedWriter.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "MappedWriter.h"
+#include <chrono>
+
+#ifndef WIN_ENV
+#include <sys/mman.h>
+#include <sys/mount.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace CanvasExport;
+
+MappedWriter::MappedWriter()
+{
+	// Initialize MappedWriter
+#ifdef WIN_ENV
+	this->file = INVALID_HANDLE_VALUE;
+	this->mapping = NULL;
+#else
+	this->file = -1;
+#endif
+	this->window = NULL;
+	this->windowOffset = 0;
+	this->isOpen = false;
+	this->hasFailed = false;
+	this->windowCount = 0;
+	this->byteCount = 0;
+	this->mapSeconds = 0.0;
+}
+
+MappedWriter::~MappedWriter()
+{
+	Close();
+}
+
+// Is the path on a local volume?
+// Only local files are worth mapping, since writing a mapped file on a network share makes the export wait on page faults
+bool MappedWriter::IsLocalPath(const std::string& path)
+{
+	// The file doesn't exist yet, so ask about its folder
+	std::string folder = path.substr(0, path.find_last_of("/\\") + 1);
+
+#ifdef WIN_ENV
+	char volume[MAX_PATH];
+	if (!GetVolumePathNameA(folder.c_str(), volume, MAX_PATH))
+	{
+		return false;
+	}
+	unsigned int type = GetDriveTypeA(volume);
+	return (type == DRIVE_FIXED || type == DRIVE_RAMDISK);
+#else
+	struct statfs info;
+	if (statfs(folder.empty() ? "." : folder.c_str(), &info) != 0)
+	{
+		return false;
+	}
+	return ((info.f_flags & MNT_LOCAL) != 0);
+#endif
+}
+
+// Create the file, and map its first window
+bool MappedWriter::Open(const std::string& path)
+{
+#ifdef WIN_ENV
+	// Create the file (we only write it front to back)
+	file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	isOpen = (file != INVALID_HANDLE_VALUE);
+#else
+	// Create the file
+	file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	isOpen = (file != -1);
+#endif
+
+	if (isOpen)
+	{
+		// Map the first window
+		windowOffset = 0;
+		hasFailed = false;
+		if (!MapWindow())
+		{
+			// Leave an empty file behind, so the caller can fall back to another writer
+			Close();
+		}
+	}
+
+	return isOpen;
+}
+
+// Trim the file to what was written and close it
+// Returns false if anything couldn't be written
+bool MappedWriter::Close()
+{
+	if (isOpen)
+	{
+		// How much did we write?
+		uint64_t size = GetSize();
+		byteCount = size;
+
+		// Publish the last (partial) block
+		if (window)
+		{
+			CopyBlock(pbase(), pptr() - pbase());
+		}
+
+		UnmapWindow();
+		setp(NULL, NULL);
+
+		// Trim the unused part of the last window
+		if (!Resize(size))
+		{
+			hasFailed = true;
+		}
+
+#ifdef WIN_ENV
+		CloseHandle(file);
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (close(file) != 0)
+		{
+			hasFailed = true;
+		}
+		file = -1;
+#endif
+		isOpen = false;
+	}
+
+	return !hasFailed;
+}
+
+// Grow the file to cover the window at windowOffset, and map it
+bool MappedWriter::MapWindow()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	bool result = Resize(windowOffset + kWindowSize);
+	if (result)
+	{
+#ifdef WIN_ENV
+		// Map the window
+		mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+		if (mapping)
+		{
+			window = (char*)MapViewOfFile(mapping, FILE_MAP_WRITE, (DWORD)(windowOffset >> 32), (DWORD)windowOffset,
+				kWindowSize);
+		}
+#else
+		// Map the window, and tell the system we'll write it front to back
+		void* address = mmap(NULL, kWindowSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, (off_t)windowOffset);
+		if (address != MAP_FAILED)
+		{
+			window = (char*)address;
+			madvise(window, kWindowSize, MADV_SEQUENTIAL);
+		}
+#endif
+		result = (window != NULL);
+	}
+
+	if (result)
+	{
+		setp(window, window + kBlockSize);
+		windowCount++;
+	}
+	else
+	{
+		UnmapWindow();
+		setp(NULL, NULL);
+		hasFailed = true;
+	}
+
+	mapSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+// Unmap the current window (the system writes it back in the background)
+void MappedWriter::UnmapWindow()
+{
+#ifdef WIN_ENV
+	if (window)
+	{
+		UnmapViewOfFile(window);
+	}
+	if (mapping)
+	{
+		CloseHandle(mapping);
+		mapping = NULL;
+	}
+#else
+	if (window)
+	{
+		munmap(window, kWindowSize);
+	}
+#endif
+	window = NULL;
+}
+
+// Set the size of the file
+bool MappedWriter::Resize(uint64_t size)
+{
+#ifdef WIN_ENV
+	LARGE_INTEGER position;
+	position.QuadPart = (LONGLONG)size;
+	return SetFilePointerEx(file, position, NULL, FILE_BEGIN) && SetEndOfFile(file);
+#else
+	return (ftruncate(file, (off_t)size) == 0);
+#endif
+}
+
+// The current window is full
+MappedWriter::int_type MappedWriter::overflow(int_type c)
+{
+	int_type result = traits_type::not_eof(c);
+	if (!isOpen || !window)
+	{
+		result = traits_type::eof();
+	}
+	else
+	{
+		// Publish the full block
+		CopyBlock(pbase(), pptr() - pbase());
+
+		char* next = epptr();
+		if (next < window + kWindowSize)
+		{
+			// Continue in the next block of this window
+			setp(next, next + kBlockSize);
+		}
+		else
+		{
+			// Continue in the next window
+			UnmapWindow();
+			windowOffset += kWindowSize;
+			if (!MapWindow())
+			{
+				result = traits_type::eof();
+			}
+		}
+
+		if (!traits_type::eq_int_type(result, traits_type::eof()) &&
+			!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+	}
+
+	return result;
+}
+
+// Number of bytes written so far (while the file is open)
+uint64_t MappedWriter::GetSize()
+{
+	return windowOffset + (window ? pptr() - window : 0);
+}
+
+// Nothing to flush, the mapping is written back by the system
+int MappedWriter::sync()
+{
+	return 0;
+}
+
+// Time the export spent growing and mapping the file (here and in the copy)
+double MappedWriter::GetStallSeconds()
+{
+	return mapSeconds + FileWriter::GetStallSeconds();
+}
+
+// Report writer statistics
+void MappedWriter::DebugInfo(std::ostream& out)
+{
+	// Bytes written so far
+	uint64_t size = (isOpen ? GetSize() : byteCount);
+
+	out << "//   Mapped output windows = " << windowCount << ", bytes = " << size <<
+		", map = " << setiosflags(ios::fixed) << setprecision(3) << mapSeconds << "s" << endl;
+
+	// Include the copy's statistics
+	if (GetCopy())
+	{
+		GetCopy()->DebugInfo(out);
+	}
+}
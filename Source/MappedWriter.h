@@ -0,0 +1,88 @@
+// MappedWriter.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef MAPPEDWRITER_H
+#define MAPPEDWRITER_H
+
+#include "IllustratorSDK.h"
+#include "FileWriter.h"
+
+#ifdef WIN_ENV
+#include <windows.h>
+#endif
+
+namespace CanvasExport
+{
+	/// Output sink that writes straight into a memory-mapped file, so code is formatted directly into the page cache
+	/// The file is mapped one window at a time and grown a window ahead, and trimmed to the written size when closed
+	/// Each window is filled a block at a time, and every full block is published to the copy (if any)
+	class MappedWriter : public FileWriter
+	{
+	private:
+
+		// Size of each mapped window (in bytes, a multiple of the page size and allocation granularity)
+		static const size_t		kWindowSize = 16 * 1024 * 1024;
+
+		// Size of the blocks each window is filled in (in bytes, divides kWindowSize)
+		static const size_t		kBlockSize = 64 * 1024;
+
+#ifdef WIN_ENV
+		HANDLE					file;					// File being written
+		HANDLE					mapping;				// Mapping of the current window
+#else
+		int						file;					// File being written
+#endif
+		char*					window;					// Current window (NULL if none)
+		uint64_t				windowOffset;			// Offset of the current window in the file
+		bool					isOpen;					// Is the file open?
+		bool					hasFailed;				// Did growing or mapping fail?
+
+		bool					MapWindow();
+		void					UnmapWindow();
+		bool					Resize(uint64_t size);
+		uint64_t				GetSize();
+
+	protected:
+
+		int_type				overflow(int_type c) override;
+		int						sync() override;
+
+	public:
+
+		MappedWriter();
+		~MappedWriter();
+
+		unsigned int			windowCount;			// Number of windows mapped
+		uint64_t				byteCount;				// Number of bytes written
+		double					mapSeconds;				// Time spent growing and mapping the file
+
+		static bool				IsLocalPath(const std::string& path);
+
+		bool					Open(const std::string& path) override;
+		bool					Close() override;
+		double					GetStallSeconds() override;
+		void					DebugInfo(std::ostream& out) override;
+
+	};
+}
+
+#endif
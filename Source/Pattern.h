@@ -28,10 +28,6 @@
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents a pattern
 	class Pattern
 	{
@@ -31,16 +31,12 @@ PatternCollection::PatternCollection()
 	this->hasPatterns = false;
 	this->hasSymbols = false;
 	this->canvasIndex = 0;
+	this->arena = NULL;
 }
 
 PatternCollection::~PatternCollection()
 {
-	// Clear patterns
-	for (unsigned int i = 0; i < patterns.size(); i++)
-	{
-		// Remove instance
-		delete patterns[i];
-	}
+	// Instances are released with the arena
 }
 
 std::vector<CanvasExport::Pattern*>& PatternCollection::Patterns()
@@ -69,7 +65,7 @@ bool PatternCollection::Add(AIPatternHandle patternHandle, bool isSymbol)
 	if (!patternExists)
 	{
 		// Create a new pattern
-		Pattern* pattern = new Pattern();
+		Pattern* pattern = arena->Create<Pattern>();
 
 		// Initialize default pattern values
 		pattern->patternHandle = patternHandle;
@@ -93,6 +89,9 @@ bool PatternCollection::Add(AIPatternHandle patternHandle, bool isSymbol)
 		// Add to vector
 		patterns.push_back(pattern);
 
+		// Index by handle
+		patternIndex[patternHandle] = pattern;
+
 		// Track this collection
 		this->hasPatterns |= (!isSymbol);
 		this->hasSymbols |= isSymbol;
@@ -106,16 +105,12 @@ CanvasExport::Pattern* PatternCollection::Find(AIPatternHandle patternHandle)
 {
 	Pattern* result = NULL;
 
-	// Loop through patterns
-	for (unsigned int i = 0; i < patterns.size(); i++)
+	// Look up the handle
+	std::unordered_map<AIPatternHandle, Pattern*>::const_iterator it = patternIndex.find(patternHandle);
+	if (it != patternIndex.end())
 	{
-		// Do the handles match?
-		if (patterns[i]->patternHandle == patternHandle)
-		{
-			// Found a match
-			result = patterns[i];
-			break;
-		}
+		// Found a match
+		result = it->second;
 	}
 
 	// Return result
@@ -24,22 +24,21 @@
 #define PATTERNCOLLECTION_H
 
 #include "IllustratorSDK.h"
+#include "Arena.h"
 #include "Ai2CanvasSuites.h"
 #include "Pattern.h"
 #include "Utility.h"
+#include <unordered_map>
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents a collection of patterns (which includes symbols)
 	class PatternCollection
 	{
 	private:
 
 		std::vector<Pattern*>	patterns;			// Collection of patterns
+		std::unordered_map<AIPatternHandle, Pattern*>	patternIndex;	// Patterns (by handle)
 		bool					hasPatterns;		// Does the collection include at least one pattern?
 		bool					hasSymbols;			// Does the collection include at least one symbol?
 		unsigned int			canvasIndex;		// Track next available canvas index
@@ -49,6 +48,8 @@ namespace CanvasExport
 		PatternCollection();
 		~PatternCollection();
 
+		Arena*					arena;				// Arena that owns the patterns
+
 		bool					Add(AIPatternHandle patternHandle, bool isSymbol);
 		Pattern*				Find(AIPatternHandle patternHandle);
 		std::vector<Pattern*>&	Patterns();
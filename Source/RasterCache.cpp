@@ -0,0 +1,926 @@
+// RasterCache.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "RasterCache.h"
+
+#ifndef WIN_ENV
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace CanvasExport;
+
+// Bump whenever the hashed content or the rasterization settings change, so old entries are ignored
+#define RASTER_CACHE_VERSION "2"
+
+// Name of the cache folder (created inside the output folder)
+#define RASTER_CACHE_FOLDER "ai2canvas-cache"
+
+// Name of the index file (inside the cache folder)
+#define RASTER_CACHE_INDEX "index.txt"
+
+// Name of the file that's locked while the index is read or written (inside the cache folder)
+#define RASTER_CACHE_LOCK "index.lock"
+
+RasterCache::RasterCache()
+{
+	// Initialize RasterCache
+	this->context = NULL;
+	this->cachePath = "";
+	this->tick = 0;
+	this->totalSize = 0;
+	this->isDirty = false;
+#ifdef WIN_ENV
+	this->lockFile = INVALID_HANDLE_VALUE;
+#else
+	this->lockFile = -1;
+#endif
+	this->maxSize = 256 * 1024 * 1024;
+	this->hits = 0;
+	this->misses = 0;
+}
+
+RasterCache::~RasterCache()
+{
+}
+
+// Open the cache that lives in the given output folder (creating it if needed)
+void RasterCache::Open(const std::string& folderPath)
+{
+	// Start empty
+	entries.clear();
+	tick = 0;
+	totalSize = 0;
+	isDirty = false;
+
+	// Make sure the cache folder exists
+	std::string path = folderPath + RASTER_CACHE_FOLDER;
+	if (CreateFolder(path))
+	{
+		// Remember the cache folder
+		cachePath = path + PATH_SEPARATOR;
+
+		// Read what we cached during previous exports (another export may be saving it right now)
+		LockIndex();
+		LoadIndex();
+		UnlockIndex();
+	}
+	else
+	{
+		// Without a folder, everything is rasterized as usual
+		cachePath = "";
+		if (context->debug)
+		{
+			context->out << "// Unable to create raster cache folder: " << path << endl;
+		}
+	}
+}
+
+// Close the cache, trimming it to its maximum size and saving the index
+void RasterCache::Close()
+{
+	// Is the cache open?
+	if (!cachePath.empty())
+	{
+		// Exports to the same folder share the index, so only one of them may merge and save at a time
+		// Without a lock (if the file system doesn't have them) we still merge, which narrows the race
+		LockIndex();
+
+		// Merge in what other exports stored since we read the index (or we'd drop their entries)
+		LoadIndex();
+
+		// Evict the least recently used files
+		Trim();
+
+		// Save the index (if anything changed)
+		if (isDirty)
+		{
+			SaveIndex();
+		}
+
+		UnlockIndex();
+
+		// Closed
+		cachePath = "";
+	}
+}
+
+// Locks the index against other exports (waiting for them), returns false if the lock isn't available
+bool RasterCache::LockIndex()
+{
+	std::string path = cachePath + RASTER_CACHE_LOCK;
+
+	// The operating system releases the lock when the file is closed (even if we crash), so a lock is never left behind
+#ifdef WIN_ENV
+	lockFile = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (lockFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	OVERLAPPED overlapped = OVERLAPPED();
+	if (!LockFileEx(lockFile, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped))
+	{
+		UnlockIndex();
+		return false;
+	}
+#else
+	lockFile = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (lockFile < 0)
+	{
+		return false;
+	}
+	if (flock(lockFile, LOCK_EX) != 0)
+	{
+		UnlockIndex();
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+// Lets other exports read and write the index again
+void RasterCache::UnlockIndex()
+{
+	// Closing the lock file releases the lock
+#ifdef WIN_ENV
+	if (lockFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(lockFile);
+		lockFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (lockFile >= 0)
+	{
+		close(lockFile);
+		lockFile = -1;
+	}
+#endif
+}
+
+// Reads the index file, dropping entries whose files are missing or don't match
+// Entries we already have are kept (only marked as used when the index says so), so this also merges what other
+// exports saved into ours
+void RasterCache::LoadIndex()
+{
+	// Open the index file
+	std::ifstream indexFile((cachePath + RASTER_CACHE_INDEX).c_str(), ios::in);
+	if (indexFile.is_open())
+	{
+		// Is this an index we understand?
+		std::string header;
+		std::getline(indexFile, header);
+		if (header == "ai2canvas raster cache " RASTER_CACHE_VERSION)
+		{
+			// Read entries, one per line ("key size lastUsed")
+			std::string line;
+			while (std::getline(indexFile, line))
+			{
+				std::istringstream fields(line);
+				std::string key;
+				Entry entry;
+				if (!(fields >> key >> entry.size >> entry.lastUsed) || key.length() != 16)
+				{
+					// Skip broken lines
+					isDirty = true;
+					continue;
+				}
+
+				// Already have it?
+				std::map<std::string, Entry>::iterator it = entries.find(key);
+				if (it != entries.end())
+				{
+					// Keep ours, but the other export may have used it more recently
+					it->second.lastUsed = std::max(it->second.lastUsed, entry.lastUsed);
+					tick = std::max(tick, entry.lastUsed);
+					continue;
+				}
+
+				// Does the file still exist with the size we recorded?
+				uint64_t size = 0;
+				if (!GetFileSize(EntryPath(key), size) || size != entry.size)
+				{
+					// Drop it (a file of the wrong size is truncated or was replaced)
+					remove(EntryPath(key).c_str());
+					isDirty = true;
+					continue;
+				}
+
+				// Keep entry
+				entries[key] = entry;
+				totalSize += entry.size;
+				tick = std::max(tick, entry.lastUsed);
+			}
+		}
+		else
+		{
+			// Written by a different version, so start over
+			isDirty = true;
+		}
+	}
+
+	if (context->debug)
+	{
+		context->out << "// Raster cache: " << entries.size() << " entries, " << totalSize << " bytes" << endl;
+	}
+}
+
+// Writes the index file
+void RasterCache::SaveIndex()
+{
+	// Open the index file
+	std::ofstream indexFile((cachePath + RASTER_CACHE_INDEX).c_str(), ios::out | ios::trunc);
+	if (indexFile.is_open())
+	{
+		// Header
+		indexFile << "ai2canvas raster cache " RASTER_CACHE_VERSION << endl;
+
+		// Entries
+		for (std::map<std::string, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+		{
+			indexFile << it->first << " " << it->second.size << " " << it->second.lastUsed << endl;
+		}
+
+		isDirty = false;
+	}
+}
+
+// Removes least recently used files until the cache fits in maxSize
+void RasterCache::Trim()
+{
+	while (totalSize > maxSize && !entries.empty())
+	{
+		// Find the least recently used entry
+		std::map<std::string, Entry>::iterator oldest = entries.begin();
+		for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+		{
+			if (it->second.lastUsed < oldest->second.lastUsed)
+			{
+				oldest = it;
+			}
+		}
+
+		// Remove it
+		remove(EntryPath(oldest->first).c_str());
+		totalSize -= oldest->second.size;
+		entries.erase(oldest);
+		isDirty = true;
+	}
+}
+
+// Full path of a cached file
+std::string RasterCache::EntryPath(const std::string& key)
+{
+	return cachePath + key + ".png";
+}
+
+// Get the cache key for an art subtree rasterized at the given scale, returns false if the art can't be cached
+bool RasterCache::GetKey(AIArtHandle artHandle, AIReal scale, std::string& key)
+{
+	// Is the cache open?
+	if (cachePath.empty())
+	{
+		return false;
+	}
+
+	// Hash the version and everything that affects the rasterized result
+	Hash hash;
+	hash.Add(std::string(RASTER_CACHE_VERSION));
+	hash.Add(scale);
+	bool isCacheable = HashArt(artHandle, hash);
+
+	// Result
+	key = hash.ToString();
+	return isCacheable;
+}
+
+// Copy a cached file to the given path, returns false on a miss
+bool RasterCache::Fetch(const std::string& key, const std::string& path)
+{
+	bool found = false;
+
+	// Do we have it?
+	std::map<std::string, Entry>::iterator it = entries.find(key);
+	if (it != entries.end())
+	{
+		// Copy it to the output folder
+		found = CopyBinaryFile(EntryPath(key), path);
+		if (found)
+		{
+			// Mark as most recently used
+			it->second.lastUsed = ++tick;
+		}
+		else
+		{
+			// The file vanished since we opened the cache
+			totalSize -= it->second.size;
+			entries.erase(it);
+		}
+		isDirty = true;
+	}
+
+	// Count result
+	if (found)
+	{
+		hits++;
+	}
+	else
+	{
+		misses++;
+	}
+
+	if (context->debug)
+	{
+		context->out << "// Raster cache " << (found ? "hit" : "miss") << ", key = " << key << endl;
+	}
+
+	return found;
+}
+
+// Add a freshly rasterized file to the cache
+void RasterCache::Store(const std::string& key, const std::string& path)
+{
+	// Is the cache open?
+	if (cachePath.empty())
+	{
+		return;
+	}
+
+	// Copy the file into the cache
+	uint64_t size = 0;
+	if (CopyBinaryFile(path, EntryPath(key)) && GetFileSize(EntryPath(key), size) && size > 0)
+	{
+		// Replace any previous entry
+		std::map<std::string, Entry>::iterator it = entries.find(key);
+		if (it != entries.end())
+		{
+			totalSize -= it->second.size;
+		}
+
+		// Add entry
+		Entry entry;
+		entry.size = size;
+		entry.lastUsed = ++tick;
+		entries[key] = entry;
+		totalSize += size;
+		isDirty = true;
+	}
+}
+
+// Hash everything about an art subtree that affects how it rasterizes
+// Returns false if the subtree contains art we can't describe (like meshes, text and pixels that didn't come from an unchanged file)
+bool RasterCache::HashArt(AIArtHandle artHandle, Hash& hash)
+{
+	bool isCacheable = true;
+
+	// Art type
+	short type = kUnknownArt;
+	sAIArt->GetArtType(artHandle, &type);
+	hash.Add((int)type);
+
+	// Visibility
+	ai::int32 attr = 0;
+	sAIArt->GetArtUserAttr(artHandle, kArtHidden, &attr);
+	hash.Add((int)attr);
+
+	// Bounds (these include transformations, and determine the rasterized size)
+	AIRealRect bounds;
+	sAIArt->GetArtBounds(artHandle, &bounds);
+	hash.Add(bounds.left);
+	hash.Add(bounds.top);
+	hash.Add(bounds.right);
+	hash.Add(bounds.bottom);
+
+	// Opacity and blending
+	hash.Add(sAIBlendStyle->GetOpacity(artHandle));
+	hash.Add((int)sAIBlendStyle->GetBlendingMode(artHandle));
+
+	// Appearance (fills, strokes and Live Effects)
+	isCacheable &= HashLiveEffects(artHandle, hash);
+
+	// Opacity mask (the mask art, and how it's applied)
+	AIMaskRef mask = NULL;
+	sAIMask->GetMask(artHandle, &mask);
+	hash.Add((int)(mask != NULL));
+	if (mask)
+	{
+		hash.Add((int)sAIMask->GetLinked(mask));
+		hash.Add((int)sAIMask->GetInverted(mask));
+		hash.Add((int)sAIMask->GetClipping(mask));
+		AIArtHandle maskArtHandle = sAIMask->GetArt(mask);
+		if (maskArtHandle)
+		{
+			isCacheable &= HashArt(maskArtHandle, hash);
+		}
+		sAIMask->Release(mask);
+	}
+
+	switch (type)
+	{
+	case kGroupArt:
+	case kCompoundPathArt:
+	{
+		// Hash children
+		AIArtHandle childArtHandle = NULL;
+		sAIArt->GetArtFirstChild(artHandle, &childArtHandle);
+		while (childArtHandle)
+		{
+			isCacheable &= HashArt(childArtHandle, hash);
+			sAIArt->GetArtSibling(childArtHandle, &childArtHandle);
+		}
+		break;
+	}
+	case kPathArt:
+	{
+		// Style
+		isCacheable &= HashPathStyle(artHandle, hash);
+
+		// Closed?
+		AIBoolean closed = false;
+		sAIPath->GetPathClosed(artHandle, &closed);
+		hash.Add((int)closed);
+
+		// Segments
+		short segmentCount = 0;
+		sAIPath->GetPathSegmentCount(artHandle, &segmentCount);
+		hash.Add((int)segmentCount);
+		for (short segmentIndex = 0; segmentIndex < segmentCount; segmentIndex++)
+		{
+			AIPathSegment segment;
+			sAIPath->GetPathSegments(artHandle, segmentIndex, 1, &segment);
+			hash.Add(segment.p.h);
+			hash.Add(segment.p.v);
+			hash.Add(segment.in.h);
+			hash.Add(segment.in.v);
+			hash.Add(segment.out.h);
+			hash.Add(segment.out.v);
+			hash.Add((int)segment.corner);
+		}
+		break;
+	}
+	case kPluginArt:
+	{
+		// Plug-in name
+		char* name = NULL;
+		AIErr result = sAIPluginGroup->GetPluginArtName(artHandle, &name);
+		if (!result && name)
+		{
+			hash.Add(std::string(name));
+		}
+
+		// The result art is what gets drawn
+		AIArtHandle resultArtHandle = NULL;
+		sAIPluginGroup->GetPluginArtResultArt(artHandle, &resultArtHandle);
+		if (resultArtHandle)
+		{
+			isCacheable &= HashArt(resultArtHandle, hash);
+		}
+		break;
+	}
+	case kSymbolArt:
+	{
+		// Symbol transformation
+		AIRealMatrix transform;
+		sAISymbol->GetSoftTransformOfSymbolArt(artHandle, &transform);
+		hash.Add(transform.a);
+		hash.Add(transform.b);
+		hash.Add(transform.c);
+		hash.Add(transform.d);
+		hash.Add(transform.tx);
+		hash.Add(transform.ty);
+
+		// Symbol definition
+		AIPatternHandle symbolPatternHandle = NULL;
+		sAISymbol->GetSymbolPatternOfSymbolArt(artHandle, &symbolPatternHandle);
+		AIArtHandle patternArtHandle = NULL;
+		sAIPattern->GetPatternArt(symbolPatternHandle, &patternArtHandle);
+		if (patternArtHandle)
+		{
+			isCacheable &= HashArt(patternArtHandle, hash);
+		}
+		break;
+	}
+	case kRasterArt:
+	case kPlacedArt:
+	{
+		// Only pixels that come from a file can be identified (we don't hash pixels)
+		// Linked files are drawn as they are on disk, embedded pixels only match their file if it hasn't changed since it was embedded
+		ai::UnicodeString path;
+		SPPlatformFileInfo fileInfo;
+		AIErr result = kNoErr;
+		if (type == kRasterArt)
+		{
+			sAIRaster->GetRasterFilePathFromArt(artHandle, path);
+			SPPlatformFileInfo artFileInfo;
+			result = sAIRaster->GetRasterFileInfoFromArt(artHandle, &artFileInfo);
+			if (!result)
+			{
+				result = sAIRaster->GetRasterFileInfoFromFile(artHandle, &fileInfo);
+			}
+			if (!result && GetModificationTime(artFileInfo) != GetModificationTime(fileInfo))
+			{
+				result = kBadParameterErr;
+			}
+		}
+		else
+		{
+			sAIPlaced->GetPlacedFilePathFromArt(artHandle, path);
+			result = sAIPlaced->GetPlacedFileInfoFromFile(artHandle, &fileInfo);
+		}
+		std::string sourcePath = path.as_Platform();
+		uint64_t size = 0;
+		if (!result && !sourcePath.empty() && GetFileSize(sourcePath, size))
+		{
+			// Path, size and modification time identify the file
+			uint64_t modificationTime = GetModificationTime(fileInfo);
+			hash.Add(sourcePath);
+			hash.Add((int)(size & 0xffffffff));
+			hash.Add((int)(size >> 32));
+			hash.Add((int)(modificationTime & 0xffffffff));
+			hash.Add((int)(modificationTime >> 32));
+
+			// Placement
+			AIRealMatrix matrix;
+			if (type == kRasterArt)
+			{
+				sAIRaster->GetRasterMatrix(artHandle, &matrix);
+			}
+			else
+			{
+				sAIPlaced->GetPlacedMatrix(artHandle, &matrix);
+			}
+			hash.Add(matrix.a);
+			hash.Add(matrix.b);
+			hash.Add(matrix.c);
+			hash.Add(matrix.d);
+			hash.Add(matrix.tx);
+			hash.Add(matrix.ty);
+		}
+		else
+		{
+			isCacheable = false;
+		}
+		break;
+	}
+	default:
+	{
+		// Meshes, text and unknown art
+		isCacheable = false;
+		break;
+	}
+	}
+
+	return isCacheable;
+}
+
+// Hash the fill and stroke of a path, returns false if they can't be described
+bool RasterCache::HashPathStyle(AIArtHandle artHandle, Hash& hash)
+{
+	bool isCacheable = true;
+
+	AIPathStyle style;
+	sAIPathStyle->GetPathStyle(artHandle, &style);
+
+	// Fill
+	hash.Add((int)style.fillPaint);
+	if (style.fillPaint)
+	{
+		isCacheable &= HashColor(style.fill.color, hash);
+	}
+	hash.Add((int)style.evenodd);
+	hash.Add((int)style.clip);
+
+	// Stroke
+	hash.Add((int)style.strokePaint);
+	if (style.strokePaint)
+	{
+		isCacheable &= HashColor(style.stroke.color, hash);
+		hash.Add(style.stroke.width);
+		hash.Add((int)style.stroke.cap);
+		hash.Add((int)style.stroke.join);
+		hash.Add(style.stroke.miterLimit);
+		hash.Add((int)style.stroke.dash.length);
+		for (short i = 0; i < style.stroke.dash.length; i++)
+		{
+			hash.Add(style.stroke.dash.array[i]);
+		}
+		hash.Add(style.stroke.dash.offset);
+	}
+
+	return isCacheable;
+}
+
+// Hash a color (hashing only the fields that are used by its kind), returns false if it can't be described
+bool RasterCache::HashColor(const AIColor& color, Hash& hash)
+{
+	bool isCacheable = true;
+
+	hash.Add((int)color.kind);
+	switch (color.kind)
+	{
+	case kGrayColor:
+	{
+		hash.Add(color.c.g.gray);
+		break;
+	}
+	case kFourColor:
+	{
+		hash.Add(color.c.f.cyan);
+		hash.Add(color.c.f.magenta);
+		hash.Add(color.c.f.yellow);
+		hash.Add(color.c.f.black);
+		break;
+	}
+	case kThreeColor:
+	{
+		hash.Add(color.c.rgb.red);
+		hash.Add(color.c.rgb.green);
+		hash.Add(color.c.rgb.blue);
+		break;
+	}
+	case kCustomColor:
+	{
+		AICustomColor customColor;
+		sAICustomColor->GetCustomColor(color.c.c.color, &customColor);
+		hash.Add((int)customColor.kind);
+		if (customColor.kind == kCustomFourColor)
+		{
+			hash.Add(customColor.c.f.cyan);
+			hash.Add(customColor.c.f.magenta);
+			hash.Add(customColor.c.f.yellow);
+			hash.Add(customColor.c.f.black);
+		}
+		else if (customColor.kind == kCustomThreeColor)
+		{
+			hash.Add(customColor.c.rgb.red);
+			hash.Add(customColor.c.rgb.green);
+			hash.Add(customColor.c.rgb.blue);
+		}
+		hash.Add(color.c.c.tint);
+		break;
+	}
+	case kPattern:
+	{
+		// Pattern tile art (editing a pattern keeps its name)
+		AIArtHandle patternArtHandle = NULL;
+		sAIPattern->GetPatternArt(color.c.p.pattern, &patternArtHandle);
+		if (patternArtHandle)
+		{
+			isCacheable &= HashArt(patternArtHandle, hash);
+		}
+		else
+		{
+			isCacheable = false;
+		}
+		hash.Add(color.c.p.transform.a);
+		hash.Add(color.c.p.transform.b);
+		hash.Add(color.c.p.transform.c);
+		hash.Add(color.c.p.transform.d);
+		hash.Add(color.c.p.transform.tx);
+		hash.Add(color.c.p.transform.ty);
+		break;
+	}
+	case kGradient:
+	{
+		// Gradient type and stops
+		ai::int16 gradientType = 0;
+		sAIGradient->GetGradientType(color.c.b.gradient, &gradientType);
+		hash.Add((int)gradientType);
+		ai::int16 count = 0;
+		sAIGradient->GetGradientStopCount(color.c.b.gradient, &count);
+		hash.Add((int)count);
+		for (ai::int16 index = 0; index < count; index++)
+		{
+			AIGradientStop gradientStop;
+			sAIGradient->GetNthGradientStop(color.c.b.gradient, index, &gradientStop);
+			hash.Add(gradientStop.rampPoint);
+			hash.Add(gradientStop.midPoint);
+			hash.Add(gradientStop.opacity);
+			isCacheable &= HashColor(gradientStop.color, hash);
+		}
+
+		// Placement
+		hash.Add(color.c.b.gradientOrigin.h);
+		hash.Add(color.c.b.gradientOrigin.v);
+		hash.Add(color.c.b.gradientAngle);
+		hash.Add(color.c.b.gradientLength);
+		hash.Add(color.c.b.hiliteAngle);
+		hash.Add(color.c.b.hiliteLength);
+		hash.Add(color.c.b.matrix.a);
+		hash.Add(color.c.b.matrix.b);
+		hash.Add(color.c.b.matrix.c);
+		hash.Add(color.c.b.matrix.d);
+		hash.Add(color.c.b.matrix.tx);
+		hash.Add(color.c.b.matrix.ty);
+		break;
+	}
+	default:
+	{
+		// No color
+		break;
+	}
+	}
+
+	return isCacheable;
+}
+
+// Hash the appearance of art: its paint fields and the parameters of its Live Effects
+// Returns false if the appearance can't be described
+bool RasterCache::HashLiveEffects(AIArtHandle artHandle, Hash& hash)
+{
+	bool isCacheable = true;
+
+	// Get the style for this art handle
+	AIArtStyleHandle artStyle = NULL;
+	sAIArtStyle->GetArtStyle(artHandle, &artStyle);
+
+	// Create a new style parser
+	AIStyleParser parser(NULL);
+	sAIArtStyleParser->NewParser(&parser);
+
+	// Parse the art style
+	sAIArtStyleParser->ParseStyle(parser, artStyle);
+
+	// Fills and strokes (an appearance can stack several of them)
+	ASInt32 paintFieldCount = sAIArtStyleParser->CountPaintFields(parser);
+	hash.Add((int)paintFieldCount);
+	for (ASInt32 paintIndex = 0; paintIndex < paintFieldCount; ++paintIndex)
+	{
+		AIParserPaintField paintField;
+		sAIArtStyleParser->GetNthPaintField(parser, paintIndex, &paintField);
+		if (sAIArtStyleParser->IsFill(paintField))
+		{
+			AIFillStyle fill;
+			AIArtStylePaintData* paintData = NULL;
+			sAIArtStyleParser->GetFill(paintField, &fill, &paintData);
+			hash.Add(std::string("fill"));
+			isCacheable &= HashColor(fill.color, hash);
+		}
+		else
+		{
+			AIStrokeStyle stroke;
+			AIArtStylePaintData* paintData = NULL;
+			sAIArtStyleParser->GetStroke(paintField, &stroke, &paintData);
+			hash.Add(std::string("stroke"));
+			isCacheable &= HashColor(stroke.color, hash);
+			hash.Add(stroke.width);
+		}
+	}
+
+	// Pre-effects, then post-effects
+	for (int pass = 0; pass < 2; pass++)
+	{
+		ASInt32 effectCount = (pass == 0) ? sAIArtStyleParser->CountPreEffects(parser) : sAIArtStyleParser->CountPostEffects(parser);
+		hash.Add((int)effectCount);
+		for (ASInt32 effectIndex = 0; effectIndex < effectCount; ++effectIndex)
+		{
+			// Get the Live Effect
+			AIParserLiveEffect liveEffect;
+			if (pass == 0)
+			{
+				sAIArtStyleParser->GetNthPreEffect(parser, effectIndex, &liveEffect);
+			}
+			else
+			{
+				sAIArtStyleParser->GetNthPostEffect(parser, effectIndex, &liveEffect);
+			}
+
+			// Effect name
+			AILiveEffectHandle liveEffectHandle;
+			sAIArtStyleParser->GetLiveEffectHandle(liveEffect, &liveEffectHandle);
+			const char *liveEffectName = NULL;
+			sAILiveEffect->GetLiveEffectName(liveEffectHandle, &liveEffectName);
+			hash.Add(std::string(liveEffectName ? liveEffectName : ""));
+
+			// Effect parameters
+			AILiveEffectParameters params = NULL;
+			sAIArtStyleParser->GetLiveEffectParams(liveEffect, &params);
+			if (params)
+			{
+				isCacheable &= HashParameters(params, hash);
+			}
+		}
+	}
+
+	// Dispose the art style parser
+	sAIArtStyleParser->DisposeParser(parser);
+
+	return isCacheable;
+}
+
+// Hash the entries of a Live Effect parameters dictionary
+// Returns false if an entry has a type we can't read (so editing it would go unnoticed)
+bool RasterCache::HashParameters(AILiveEffectParameters params, Hash& hash)
+{
+	bool isCacheable = true;
+
+	// Create an iterator for the parameters dictionary items
+	AIDictionaryIterator dictionaryIter = NULL;
+	sAIDictionary->Begin(params, &dictionaryIter);
+
+	// Iterate through the parameter dictionary entries
+	while (!sAIDictionaryIterator->AtEnd(dictionaryIter))
+	{
+		// Get the dictionary key
+		AIDictKey dictKey = sAIDictionaryIterator->GetKey(dictionaryIter);
+		const char *keyString = sAIDictionary->GetKeyString(dictKey);
+		hash.Add(std::string(keyString ? keyString : ""));
+
+		// Get the entry type
+		AIEntryType entryType = UnknownType;
+		sAIDictionary->GetEntryType(params, dictKey, &entryType);
+		hash.Add((int)entryType);
+
+		// Hash the values we can read
+		switch (entryType)
+		{
+		case IntegerType:
+		{
+			ai::int32 value = 0;
+			sAIDictionary->GetIntegerEntry(params, dictKey, &value);
+			hash.Add((int)value);
+			break;
+		}
+		case BooleanType:
+		{
+			ASBoolean value = false;
+			sAIDictionary->GetBooleanEntry(params, dictKey, &value);
+			hash.Add((int)value);
+			break;
+		}
+		case RealType:
+		{
+			AIReal value = 0.0f;
+			sAIDictionary->GetRealEntry(params, dictKey, &value);
+			hash.Add(value);
+			break;
+		}
+		case StringType:
+		{
+			const char *value = NULL;
+			sAIDictionary->GetStringEntry(params, dictKey, &value);
+			hash.Add(std::string(value ? value : ""));
+			break;
+		}
+		case PointType:
+		{
+			AIRealPoint value;
+			sAIDictionary->GetPointEntry(params, dictKey, &value);
+			hash.Add(value.h);
+			hash.Add(value.v);
+			break;
+		}
+		case FillStyleType:
+		{
+			AIEntryRef entryRef = sAIDictionary->Get(params, dictKey);
+			AIFillStyle fillStyle;
+			sAIEntry->ToFillStyle(entryRef, &fillStyle);
+			isCacheable &= HashColor(fillStyle.color, hash);
+			break;
+		}
+		default:
+		{
+			// Dictionaries, arrays, art and other types aren't read
+			isCacheable = false;
+			break;
+		}
+		}
+
+		// Move to the next dictionary entry
+		sAIDictionaryIterator->Next(dictionaryIter);
+	}
+
+	// Release the dictionary iterator
+	sAIDictionaryIterator->Release(dictionaryIter);
+
+	return isCacheable;
+}
+
+void RasterCache::DebugInfo(std::ostream& out)
+{
+	// Cache statistics
+	out << "//   Raster cache hits = " << hits << ", misses = " << misses << endl;
+	out << "//   Raster cache entries = " << entries.size() << ", size = " << totalSize << " bytes (max " << maxSize << ")" << endl;
+}
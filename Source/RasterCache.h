@@ -0,0 +1,93 @@
+// RasterCache.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef RASTERCACHE_H
+#define RASTERCACHE_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include "Hash.h"
+#include "ExportContext.h"
+#include <map>
+
+#ifdef WIN_ENV
+#include <windows.h>
+#endif
+
+namespace CanvasExport
+{
+	/// Keeps rasterized PNG files between exports, keyed by a hash of the art they were made from
+	class RasterCache
+	{
+	private:
+
+		/// Represents a single cached PNG file
+		struct Entry
+		{
+			uint64_t			size;				// File size (in bytes)
+			uint64_t			lastUsed;			// Use tick (higher is more recent)
+		};
+
+		std::map<std::string, Entry>	entries;	// Cached files (by key)
+		std::string			cachePath;				// Path to the cache folder (empty if the cache isn't available)
+		uint64_t			tick;					// Use tick counter
+		uint64_t			totalSize;				// Total size of all cached files (in bytes)
+		bool				isDirty;				// Does the index need to be saved?
+#ifdef WIN_ENV
+		HANDLE				lockFile;				// Locked while the index is read or written
+#else
+		int					lockFile;				// Locked while the index is read or written
+#endif
+
+		bool				LockIndex();
+		void				UnlockIndex();
+		void				LoadIndex();
+		void				SaveIndex();
+		void				Trim();
+		std::string			EntryPath(const std::string& key);
+		bool				HashArt(AIArtHandle artHandle, Hash& hash);
+		bool				HashPathStyle(AIArtHandle artHandle, Hash& hash);
+		bool				HashColor(const AIColor& color, Hash& hash);
+		bool				HashLiveEffects(AIArtHandle artHandle, Hash& hash);
+		bool				HashParameters(AILiveEffectParameters params, Hash& hash);
+
+	public:
+
+		RasterCache();
+		~RasterCache();
+
+		ExportContext*		context;				// Export the cache is used by
+		uint64_t			maxSize;				// Maximum total size of cached files (in bytes)
+		unsigned int		hits;					// Number of rasterizations served from the cache
+		unsigned int		misses;					// Number of rasterizations that had to be made
+
+		void				Open(const std::string& folderPath);
+		void				Close();
+		bool				GetKey(AIArtHandle artHandle, AIReal scale, std::string& key);
+		bool				Fetch(const std::string& key, const std::string& path);
+		void				Store(const std::string& key, const std::string& path);
+		void				DebugInfo(std::ostream& out);
+
+	};
+}
+
+#endif
@@ -0,0 +1,116 @@
+// SourceMap.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "SourceMap.h"
+#include "Utility.h"
+
+using namespace CanvasExport;
+
+SourceMap::SourceMap()
+{
+}
+
+SourceMap::~SourceMap()
+{
+}
+
+// Returns the index of a source (adding it the first time it's seen)
+int SourceMap::AddSource(const std::string& path)
+{
+	std::map<std::string, int>::iterator iter = sourceIndexes.find(path);
+	if (iter != sourceIndexes.end())
+	{
+		return iter->second;
+	}
+
+	int index = (int)sources.size();
+	sources.push_back(path);
+	sourceIndexes[path] = index;
+	return index;
+}
+
+// Append a base64 VLQ value (as used in source map mappings)
+void SourceMap::AppendVLQ(std::string& out, int value)
+{
+	static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	// Sign goes in the lowest bit
+	unsigned int vlq = (value < 0) ? (((unsigned int)-value << 1) | 1) : ((unsigned int)value << 1);
+	do
+	{
+		unsigned int digit = vlq & 0x1F;
+		vlq >>= 5;
+		if (vlq > 0)
+		{
+			// More digits follow
+			digit |= 0x20;
+		}
+		out.push_back(digits[digit]);
+	} while (vlq > 0);
+}
+
+// Write the source map for a generated file
+bool SourceMap::Write(const std::string& path, const std::string& file)
+{
+	// Mappings: one segment at the start of each mapped line (columns restart on each line, sources are relative to
+	// the previous segment, and every source starts at line 0, column 0)
+	std::string mappings;
+	int previousSource = 0;
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		if (i > 0)
+		{
+			mappings.push_back(';');
+		}
+		if (lines[i] >= 0)
+		{
+			AppendVLQ(mappings, 0);
+			AppendVLQ(mappings, lines[i] - previousSource);
+			AppendVLQ(mappings, 0);
+			AppendVLQ(mappings, 0);
+			previousSource = lines[i];
+		}
+	}
+
+	// Open the map file
+	std::ofstream mapFile(path.c_str(), ios::out | ios::trunc);
+	if (!mapFile.is_open())
+	{
+		return false;
+	}
+
+	mapFile << "{\"version\":3,\"file\":\"" << EscapeJSON(file) << "\",\"sources\":[";
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		mapFile << (i > 0 ? "," : "") << "\"" << EscapeJSON(sources[i]) << "\"";
+	}
+	mapFile << "],\"names\":[],\"mappings\":\"" << mappings << "\"}" << endl;
+
+	return !mapFile.fail();
+}
+
+// Report source map statistics
+void SourceMap::DebugInfo(std::ostream& out)
+{
+	out << "//   Source map: " << sources.size() << " sources, " << lines.size() << " lines" << endl;
+}
@@ -0,0 +1,58 @@
+// SourceMap.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SOURCEMAP_H
+#define SOURCEMAP_H
+
+#include "IllustratorSDK.h"
+#include <map>
+#include <vector>
+
+namespace CanvasExport
+{
+	/// Maps generated lines back to the art that produced them, written as a standard (version 3) source map
+	/// Each art path (layer/group/art, followed by the art's UID if it has one) is a source, so browser tools
+	/// show which artwork a line of code draws
+	class SourceMap
+	{
+	private:
+
+		std::map<std::string, int>	sourceIndexes;		// Index of each source (by path)
+
+		static void				AppendVLQ(std::string& out, int value);
+
+	public:
+
+		SourceMap();
+		~SourceMap();
+
+		std::vector<std::string>	sources;			// Art paths
+		std::vector<int>		lines;					// Source of each generated line (-1 if none)
+
+		int						AddSource(const std::string& path);
+		bool					Write(const std::string& path, const std::string& file);
+		void					DebugInfo(std::ostream& out);
+
+	};
+}
+
+#endif
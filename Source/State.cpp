@@ -27,21 +27,18 @@ using namespace CanvasExport;
 
 State::State()
 {
-	// Default color string
-	const std::string defaultColor("\"rgb(0, 0, 0)\"");
-
 	// Initialize State
 	// NOTE: These are the HTML5 canvas defaults: http://www.whatwg.org/specs/web-apps/current-work/multipage/the-canvas-element.html#2dcontext
 	this->globalAlpha = 1.0f;
-	this->fillStyle = "";
-	this->strokeStyle = "";
+	this->fillStyle = StringTable::kEmptyString;
+	this->strokeStyle = StringTable::kEmptyString;
 	this->lineWidth = 1.0f;
 	this->lineCap = kAIButtCap;
 	this->lineJoin = kAIMiterJoin;
 	this->miterLimit = 10.0f;
 	this->fontSize = 10.0f;
-	this->fontName = "sans-serif";
-	this->fontStyleName = "Regular";
+	this->fontName = StringTable::kEmptyString;			// Canvas sets "sans-serif"
+	this->fontStyleName = StringTable::kEmptyString;	// Canvas sets "Regular"
 	this->isProcessingSymbol = false;
 	sAIRealMath->AIRealMatrixSetIdentity(&this->internalTransform);
 }
@@ -51,20 +48,20 @@ State::~State()
 }
 
 // Report state information
-void State::DebugInfo()
+void State::DebugInfo(std::ostream& out, const StringTable& strings)
 {
-	outFile << "// State Info" << endl;
-	outFile << "//   globalAlpha = " << setiosflags(ios::fixed) << setprecision(2) << this->globalAlpha << endl;
-	outFile << "//   fillStyle = " << this->fillStyle << endl;
-	outFile << "//   strokeStyle = " << this->strokeStyle << endl;
-	outFile << "//   lineWidth = " << setiosflags(ios::fixed) << setprecision(1) << this->lineWidth << endl;
-	outFile << "//   lineCap = " << this->lineCap << endl;
-	outFile << "//   lineJoin = " << this->lineJoin << endl;
-	outFile << "//   miterLimit = " << setiosflags(ios::fixed) << setprecision(1) << this->miterLimit << endl;
-	outFile << "//   fontSize = " << setiosflags(ios::fixed) << setprecision(1) << this->fontSize << endl;
-	outFile << "//   fontName = " << this->fontName << endl;
-	outFile << "//   fontStyleName = " << this->fontStyleName << endl;
-	outFile << "//   isProcessingSymbol = " << this->isProcessingSymbol << endl;
-	outFile << "//   internalTransform = " << endl;
+	out << "// State Info" << endl;
+	out << "//   globalAlpha = " << setiosflags(ios::fixed) << setprecision(2) << this->globalAlpha << endl;
+	out << "//   fillStyle = " << strings.Get(this->fillStyle) << endl;
+	out << "//   strokeStyle = " << strings.Get(this->strokeStyle) << endl;
+	out << "//   lineWidth = " << setiosflags(ios::fixed) << setprecision(1) << this->lineWidth << endl;
+	out << "//   lineCap = " << this->lineCap << endl;
+	out << "//   lineJoin = " << this->lineJoin << endl;
+	out << "//   miterLimit = " << setiosflags(ios::fixed) << setprecision(1) << this->miterLimit << endl;
+	out << "//   fontSize = " << setiosflags(ios::fixed) << setprecision(1) << this->fontSize << endl;
+	out << "//   fontName = " << strings.Get(this->fontName) << endl;
+	out << "//   fontStyleName = " << strings.Get(this->fontStyleName) << endl;
+	out << "//   isProcessingSymbol = " << this->isProcessingSymbol << endl;
+	out << "//   internalTransform = " << endl;
 	//RenderTransform(state.internalTransform);
 }
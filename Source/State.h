@@ -25,14 +25,12 @@
 
 #include "IllustratorSDK.h"
 #include "Utility.h"
+#include "StringTable.h"
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
 	/// Represents a context drawing state
+	/// Strings are interned (see StringTable), so copying a state is just copying a few words
 	class State
 	{
 	private:
@@ -43,19 +41,19 @@ namespace CanvasExport
 		~State();
 
 		AIReal				globalAlpha;			// Global canvas alpha value (0.0 - 1.0)
-		std::string			fillStyle;				// String fill style (e.g. "rgb(0, 0, 0)")
-		std::string			strokeStyle;			// String stroke style (e.g. "rgb(0, 0, 0)")
+		unsigned int		fillStyle;				// Interned fill style (e.g. "rgb(0, 0, 0)")
+		unsigned int		strokeStyle;			// Interned stroke style (e.g. "rgb(0, 0, 0)")
 		AIReal				lineWidth;				// Stroke width (in pixels)
 		AILineCap			lineCap;				// Cap type
 		AILineJoin			lineJoin;				// Join type
 		AIReal				miterLimit;				// Stroke miter limit
 		AIReal				fontSize;				// Font size (in pixels)
-		std::string			fontName;				// Font name
-		std::string			fontStyleName;			// Style name
+		unsigned int		fontName;				// Interned font name
+		unsigned int		fontStyleName;			// Interned style name
 		AIBoolean			isProcessingSymbol;		// Is an Illustrator symbol being processed?
 		AIRealMatrix		internalTransform;		// Internal transformation for adjustments from Illustrator to canvas coordinate space
 
-		void				DebugInfo();
+		void				DebugInfo(std::ostream& out, const StringTable& strings);
 	};
 
 }
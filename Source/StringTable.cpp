@@ -0,0 +1,66 @@
+// StringTable.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "StringTable.h"
+
+using namespace CanvasExport;
+
+StringTable::StringTable()
+{
+	// The empty string is always ID 0
+	Intern("");
+}
+
+StringTable::~StringTable()
+{
+}
+
+// Returns the ID of a string (adding it if it's new)
+unsigned int StringTable::Intern(const std::string& s)
+{
+	// Have we seen it?
+	std::unordered_map<std::string, unsigned int>::const_iterator it = ids.find(s);
+	if (it != ids.end())
+	{
+		return it->second;
+	}
+
+	// Add it with the next ID
+	unsigned int id = (unsigned int)strings.size();
+	strings.push_back(s);
+	ids[s] = id;
+
+	return id;
+}
+
+// Returns the string with the given ID
+const std::string& StringTable::Get(unsigned int id) const
+{
+	return strings[id];
+}
+
+// Number of distinct strings
+size_t StringTable::Size() const
+{
+	return strings.size();
+}
@@ -0,0 +1,57 @@
+// StringTable.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include <unordered_map>
+
+namespace CanvasExport
+{
+	/// Interns strings as small integer IDs, so they can be stored and compared as cheaply as numbers
+	class StringTable
+	{
+	private:
+
+		std::unordered_map<std::string, unsigned int>	ids;		// IDs (by string)
+		std::vector<std::string>	strings;		// Strings (by ID)
+
+	public:
+
+		enum
+		{
+			kEmptyString = 0						// ID of ""
+		};
+
+		StringTable();
+		~StringTable();
+
+		unsigned int		Intern(const std::string& s);
+		const std::string&	Get(unsigned int id) const;
+		size_t				Size() const;
+
+	};
+}
+
+#endif
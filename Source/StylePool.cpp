@@ -0,0 +1,94 @@
+// StylePool.cpp
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IllustratorSDK.h"
+#include "StylePool.h"
+
+using namespace CanvasExport;
+
+StylePool::StylePool()
+{
+	// Initialize StylePool
+	this->colorCount = 0;
+	this->fontCount = 0;
+	this->lineWidthCount = 0;
+}
+
+StylePool::~StylePool()
+{
+}
+
+// Returns the constant name for a value, adding a constant if this is a new value
+// NOTE: Names start with "$", which never appears in function names
+const std::string& StylePool::Reference(const std::string& prefix, unsigned int& count, const std::string& value)
+{
+	// Have we seen this value before?
+	std::string key = prefix + value;
+	std::unordered_map<std::string, std::string>::iterator it = names.find(key);
+	if (it != names.end())
+	{
+		return it->second;
+	}
+
+	// Create a new constant
+	std::ostringstream name;
+	name << prefix << count++;
+	constantNames.push_back(name.str());
+	constantValues.push_back(value);
+
+	return names[key] = name.str();
+}
+
+// Constant for a color value (including double quotes)
+const std::string& StylePool::Color(const std::string& value)
+{
+	return Reference("$c", colorCount, value);
+}
+
+// Constant for a font value (including double quotes)
+const std::string& StylePool::Font(const std::string& value)
+{
+	return Reference("$f", fontCount, value);
+}
+
+// Constant for a line width
+const std::string& StylePool::LineWidth(AIReal width)
+{
+	std::ostringstream value;
+	value << setiosflags(ios::fixed) << setprecision(1) << width;
+	return Reference("$w", lineWidthCount, value.str());
+}
+
+// Render the constants
+// NOTE: Drawing code only runs after the module has been evaluated, so the constants can follow the functions that use them
+void StylePool::Render(std::ostream& out)
+{
+	// Anything to render?
+	if (!constantNames.empty())
+	{
+		out << endl;
+		for (size_t i = 0; i < constantNames.size(); i++)
+		{
+			out << "const " << constantNames[i] << " = " << constantValues[i] << ";" << endl;
+		}
+	}
+}
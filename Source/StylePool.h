@@ -0,0 +1,60 @@
+// StylePool.h
+//
+// Copyright (c) 2010-2014 Mike Swanson (http://blog.mikeswanson.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef STYLEPOOL_H
+#define STYLEPOOL_H
+
+#include "IllustratorSDK.h"
+#include "Utility.h"
+#include <unordered_map>
+
+namespace CanvasExport
+{
+	/// Collects the distinct style values (colors, fonts and line widths) of a module, so drawing code can refer to
+	/// module-level constants instead of repeating literals
+	class StylePool
+	{
+	private:
+
+		std::unordered_map<std::string, std::string>	names;		// Constant names (by prefix and value)
+		std::vector<std::string>	constantNames;		// Constant names (in order of first use)
+		std::vector<std::string>	constantValues;		// Constant values (in order of first use)
+		unsigned int				colorCount;			// Number of color constants
+		unsigned int				fontCount;			// Number of font constants
+		unsigned int				lineWidthCount;		// Number of line width constants
+
+		const std::string&	Reference(const std::string& prefix, unsigned int& count, const std::string& value);
+
+	public:
+
+		StylePool();
+		~StylePool();
+
+		const std::string&	Color(const std::string& value);
+		const std::string&	Font(const std::string& value);
+		const std::string&	LineWidth(AIReal width);
+		void				Render(std::ostream& out);
+
+	};
+}
+
+#endif
@@ -30,32 +30,44 @@
 
 using namespace CanvasExport;
 
-TypescriptDocument::TypescriptDocument(const std::string& pathName)
+TypescriptDocument::TypescriptDocument(const std::string& pathName, ExportContext& context)
+	: resources(context)
 {
 	// Initialize Document
+	this->context = &context;
 	this->mainCanvas = NULL;
 	this->fileName = "";
+	this->scanLayer = NULL;
+
+	// Collections allocate from the document's arena
+	canvases.arena = &resources.arena;
+	functions.arena = &resources.arena;
+	functions.context = &context;
 
 	// Parse the folder path
 	ParseFolderPath(pathName);
 
 	// Add a canvas for the primary document
-	this->mainCanvas = canvases.Add("canvas", "ctx", &resources);
+	this->mainCanvas = canvases.Add("canvas", context.contextName, &resources);
 }
 
 TypescriptDocument::~TypescriptDocument()
 {
-	// Clear layers
-	for (unsigned int i = 0; i < layers.size(); i++)
-	{
-		// Remove instance
-		delete layers[i];
-	}
+	// Layers are released with the arena
 }
 
 void TypescriptDocument::Render()
 {
-	outFile << "/* tslint:disable */" << endl;
+	context->out << "/* tslint:disable */" << endl;
+
+	// Reuse art rasterized by previous exports
+	resources.rasterCache.Open(resources.folderPath);
+
+	// Image paths in the report start at the document's folder
+	if (context->report)
+	{
+		context->report->folderPath = resources.folderPath;
+	}
 
 	// Scan the document for layers and layer attributes
 	ScanDocument();
@@ -65,6 +77,52 @@ void TypescriptDocument::Render()
 
 	// Render the document
 	RenderDocument();
+
+	// Write the image manifest (so pages can find the content-named files)
+	resources.images.WriteManifest(resources.folderPath + fileName + ".manifest.json");
+
+	// Write the size and draw cost report (so the expensive artwork can be found)
+	if (context->report)
+	{
+		// Include the time spent waiting on the output file so far
+		if (context->writer)
+		{
+			context->report->outputStallSeconds = context->writer->GetStallSeconds();
+		}
+
+		context->report->WriteJSON(resources.folderPath + fileName + ".report.json");
+		context->report->WriteHTML(resources.folderPath + fileName + ".report.html");
+	}
+
+	// Report statistics
+	if (context->debug)
+	{
+		resources.colors.DebugInfo(context->out);
+		resources.rasterCache.DebugInfo(context->out);
+		resources.arena.DebugInfo(context->out);
+		resources.traversal.DebugInfo(context->out);
+		resources.artInfo.DebugInfo(context->out);
+		resources.artStyles.DebugInfo(context->out);
+		resources.fonts.DebugInfo(context->out);
+		resources.glyphs.DebugInfo(context->out);
+		if (context->sourceMap)
+		{
+			context->sourceMap->DebugInfo(context->out);
+		}
+		if (context->writer)
+		{
+			context->writer->DebugInfo(context->out);
+		}
+	}
+
+	// Keep the rasterized art for the next export
+	resources.rasterCache.Close();
+
+	// Take back the temporary art (native rasters and text outlines), so the export doesn't modify the document or add undo steps
+	if (resources.hasTemporaryArt)
+	{
+		sAIUndo->UndoChanges();
+	}
 }
 
 // Set the bounds for the primary document
@@ -158,9 +216,9 @@ void TypescriptDocument::ParseLayerName(const Layer& layer, std::string& name, s
 				// Copy options
 				optionValue = name.substr((index + 1), (length - index - 3));
 
-				if (debug)
+				if (context->debug)
 				{
-					outFile << "//   Found options = " << optionValue << endl;
+					context->out << "//   Found options = " << optionValue << endl;
 				}
 
 				// Terminate the layer name starting at the opening parenthesis
@@ -186,20 +244,20 @@ void TypescriptDocument::ParseLayerName(const Layer& layer, std::string& name, s
 // Render the document
 void TypescriptDocument::RenderDocument()
 {
-	outFile << "/* tslint:disable */" << endl;
+	context->out << "/* tslint:disable */" << endl;
 
 	// Set document bounds
 	SetDocumentBounds();
 
 	// Output document bounds
-	outFile << "export const bounds = "
+	context->out << "export const bounds = "
 		<< "{ left: " << fixed << artboardBounds.left
 		<< ", top: " << fixed << artboardBounds.top
 		<< ", width: " << fixed << artboardBounds.right - artboardBounds.left
 		<< ", height: " << fixed << artboardBounds.top - artboardBounds.bottom
 		<< "  }; " << endl;
 
-	outFile << endl;
+	context->out << endl;
 
 	// Render the symbol functions
 	RenderSymbolFunctions();
@@ -207,15 +265,27 @@ void TypescriptDocument::RenderDocument()
 	// Render the pattern function
 	RenderPatternFunction();
 
+	// Render the functions/layers
+	functions.RenderDrawFunctions(artboardBounds);
+
+	// Do we need the image density selector?
+	if (resources.images.HasVariants())
+	{
+		resources.images.RenderSelectImage();
+	}
+
+	// Render the style constants used by all functions
+	resources.styles.Render(context->out);
+
+	// Render the glyph outlines used by text exported as geometry
+	resources.glyphs.Render(context->out);
 
 	// Do we need a pattern function?
+	// NOTE: This runs while the module loads, so it has to follow the style constants
 	if (mainCanvas->documentResources->patterns.HasPatterns())
 	{
-		outFile << "drawPatterns();";
+		context->out << endl << "drawPatterns();" << endl;
 	}
-
-	// Render the functions/layers
-	functions.RenderDrawFunctions(artboardBounds);
 }
 
 // Set the options for a draw or animation function
@@ -276,16 +346,16 @@ void TypescriptDocument::ScanDocument()
 		// Is the layer visible?
 		AIBoolean isLayerVisible = false;
 		sAILayer->GetLayerVisible(layerHandle, &isLayerVisible);
-		if (debug)
+		if (context->debug)
 		{
-			outFile << "// Layer visible = " << isLayerVisible << endl;
+			context->out << "// Layer visible = " << isLayerVisible << endl;
 		}
 
 		// Only process if the layer is visible
 		if (isLayerVisible)
 		{
 			// Add this layer
-			Layer* layer = AddLayer(layers, layerHandle);
+			Layer* layer = AddLayer(layers, layerHandle, resources.arena, *context);
 
 			// Scan this layer
 			ScanLayer(*layer);
@@ -309,159 +379,196 @@ void TypescriptDocument::ScanLayer(Layer& layer)
 // Scans a layer's artwork tree to capture important data
 void TypescriptDocument::ScanLayerArtwork(AIArtHandle artHandle, unsigned int depth, Layer& layer)
 {
-	// Loop through all artwork at this depth
-	do
-	{
-		// Is this art visible?
-		AIBoolean isArtVisible = false;
-		ai::int32 attr = 0;
-		sAIArt->GetArtUserAttr(artHandle, kArtHidden, &attr);
-		isArtVisible = !((attr &kArtHidden) == kArtHidden);
-
-		// Only consider if art is visible
-		if (isArtVisible)
-		{
-			// Get the art bounds
-			AIRealRect artBounds;
-			sAIArt->GetArtBounds(artHandle, &artBounds);
+	// Capture into this layer (restoring the outer layer afterwards, since symbols scan into their own)
+	Layer* outerLayer = scanLayer;
+	scanLayer = &layer;
 
-			// Update the bounds
-			UpdateBounds(artBounds, layer.bounds);
+	// Walk the artwork in document order (see Enter, GetChildren and Leave)
+	resources.traversal.Run(*this, artHandle, depth, ArtTraversal::kDocumentOrder);
 
-			// Get type
-			short type = 0;
-			sAIArt->GetArtType(artHandle, &type);
+	scanLayer = outerLayer;
+}
 
-			// Is this symbol art?
-			if (type == kSymbolArt)
-			{
-				// Get the symbol pattern
-				AIPatternHandle symbolPatternHandle = nil;
-				sAISymbol->GetSymbolPatternOfSymbolArt(artHandle, &symbolPatternHandle);
+// Scans an art object, returns true if its children should be scanned next
+bool TypescriptDocument::Enter(AIArtHandle artHandle, unsigned int& depth)
+{
+	// Art properties (rendering will need most of them again)
+	ArtInfoCache& artInfo = resources.artInfo;
 
-				// Add the symbol pattern
-				bool added = mainCanvas->documentResources->patterns.Add(symbolPatternHandle, true);
+	// Is this art visible?
+	AIBoolean isArtVisible = !artInfo.IsHidden(artHandle);
 
-				// If we added a new pattern, scan its artwork
-				if (added)
-				{
-					AIArtHandle patternArtHandle = NULL;
-					sAIPattern->GetPatternArt(symbolPatternHandle, &patternArtHandle);
-
-					// Look inside, but don't screw up bounds for our current layer
-					Layer symbolLayer;
-					ScanLayerArtwork(patternArtHandle, (depth + 1), symbolLayer);
-
-					// Capture features for pattern
-					Pattern* pattern = mainCanvas->documentResources->patterns.Find(symbolPatternHandle);
-					pattern->hasGradients = symbolLayer.hasGradients;
-					pattern->hasPatterns = symbolLayer.hasPatterns;		// Can this ever happen?
-					pattern->hasAlpha = symbolLayer.hasAlpha;
-				}
-			}
-			else if (type == kPluginArt)
-			{
-				// Get the result art handle
-				AIArtHandle resultArtHandle = NULL;
-				sAIPluginGroup->GetPluginArtResultArt(artHandle, &resultArtHandle);
+	// Only consider if art is visible
+	if (isArtVisible)
+	{
+		// Update the bounds
+		UpdateBounds(artInfo.GetBounds(artHandle), scanLayer->bounds);
 
-				// Get the first art element in the result group
-				AIArtHandle childArtHandle = NULL;
-				sAIArt->GetArtFirstChild(resultArtHandle, &childArtHandle);
+		// Get type
+		short type = artInfo.GetType(artHandle);
 
-				// Look inside the result group
-				ScanLayerArtwork(childArtHandle, (depth + 1), layer);
-			}
+		// Is this symbol art?
+		if (type == kSymbolArt)
+		{
+			// Get the symbol pattern
+			AIPatternHandle symbolPatternHandle = nil;
+			sAISymbol->GetSymbolPatternOfSymbolArt(artHandle, &symbolPatternHandle);
+
+			// Add the symbol pattern
+			bool added = mainCanvas->documentResources->patterns.Add(symbolPatternHandle, true);
 
-			// Get opacity
-			AIReal opacity = sAIBlendStyle->GetOpacity(artHandle);
-			if (opacity != 1.0f)
+			// If we added a new pattern, scan its artwork
+			// (this nests a walk, but only once per symbol definition)
+			if (added)
 			{
-				// Flag that this layer includes alpha/opacity changes
-				layer.hasAlpha = true;
+				AIArtHandle patternArtHandle = NULL;
+				sAIPattern->GetPatternArt(symbolPatternHandle, &patternArtHandle);
+
+				// Look inside, but don't screw up bounds for our current layer
+				Layer symbolLayer;
+				ScanLayerArtwork(patternArtHandle, (depth + 1), symbolLayer);
+
+				// Capture features for pattern
+				Pattern* pattern = mainCanvas->documentResources->patterns.Find(symbolPatternHandle);
+				pattern->hasGradients = symbolLayer.hasGradients;
+				pattern->hasPatterns = symbolLayer.hasPatterns;		// Can this ever happen?
+				pattern->hasAlpha = symbolLayer.hasAlpha;
 			}
+		}
 
-			// Get the style for this artwork
-			AIPathStyle style;
-			sAIPathStyle->GetPathStyle(artHandle, &style);
+		// Plug-in art is styled after its result group has been scanned (see GetChildren)
+		if (type != kPluginArt)
+		{
+			ScanArtStyle(artHandle);
+		}
+	}
 
-			// Does this artwork use a pattern fill or a gradient?
-			if (style.fillPaint)
-			{
-				switch (style.fill.color.kind)
-				{
-				case kPattern:
-				{
-					// Add the pattern
-					mainCanvas->documentResources->patterns.Add(style.fill.color.c.p.pattern, false);
+	return (isArtVisible != 0);
+}
 
-					// Flag that this layer includes patterns
-					layer.hasPatterns = true;
-					break;
-				}
-				case kGradient:
-				{
-					// Flag that this layer includes gradients
-					layer.hasGradients = true;
-					break;
-				}
-				case kGrayColor:
-				case kFourColor:
-				case kCustomColor:
-				case kThreeColor:
-				case kNoneColor:
-				{
-					break;
-				}
-				}
-			}
+// Returns the children to scan for visible art
+bool TypescriptDocument::GetChildren(AIArtHandle artHandle, unsigned int depth, unsigned int pass, AIArtHandle& firstChild, unsigned int& childDepth)
+{
+	bool hasChildren = false;
 
-			// Does this artwork use a pattern stroke?
-			if (style.strokePaint)
-			{
-				switch (style.stroke.color.kind)
-				{
-				case kPattern:
-				{
-					// Add the pattern
-					mainCanvas->documentResources->patterns.Add(style.stroke.color.c.p.pattern, false);
+	// Get type
+	short type = resources.artInfo.GetType(artHandle);
 
-					// Flag that this layer includes patterns
-					layer.hasPatterns = true;
-					break;
-				}
-				case kGradient:
-				{
-					// Flag that this layer includes gradients
-					layer.hasGradients = true;
-					break;
-				}
-				case kGrayColor:
-				case kFourColor:
-				case kCustomColor:
-				case kThreeColor:
-				case kNoneColor:
-				{
-					break;
-				}
-				}
-			}
+	// Children are always scanned at the next depth
+	childDepth = depth + 1;
 
-			// See if this artwork has any children
-			AIArtHandle childArtHandle = NULL;
-			sAIArt->GetArtFirstChild(artHandle, &childArtHandle);
+	// Plug-in art has its result group first
+	if (type == kPluginArt && pass == 0)
+	{
+		// Get the result art handle
+		AIArtHandle resultArtHandle = NULL;
+		sAIPluginGroup->GetPluginArtResultArt(artHandle, &resultArtHandle);
 
-			// Did we find anything?
-			if (childArtHandle)
-			{
-				// Scan artwork at the next depth
-				ScanLayerArtwork(childArtHandle, (depth + 1), layer);
-			}
+		// Look inside the result group
+		sAIArt->GetArtFirstChild(resultArtHandle, &firstChild);
+		hasChildren = true;
+	}
+	else if (pass == ((type == kPluginArt) ? 1 : 0))
+	{
+		// Now that the result group is done, capture the plug-in art's own style
+		if (type == kPluginArt)
+		{
+			ScanArtStyle(artHandle);
 		}
 
-		// Find the next sibling
-		sAIArt->GetArtSibling(artHandle, &artHandle);
-	} while (artHandle != NULL);
+		// See if this artwork has any children
+		sAIArt->GetArtFirstChild(artHandle, &firstChild);
+		hasChildren = true;
+	}
+
+	return hasChildren;
+}
+
+// Nothing to do once an art object's children have been scanned
+void TypescriptDocument::Leave(AIArtHandle artHandle, unsigned int depth)
+{
+	(void)artHandle;
+	(void)depth;
+}
+
+// Captures the opacity, patterns and gradients used by an art object
+void TypescriptDocument::ScanArtStyle(AIArtHandle artHandle)
+{
+	// Layer being scanned
+	Layer& layer = *scanLayer;
+
+	// Get opacity
+	AIReal opacity = resources.artInfo.GetOpacity(artHandle);
+	if (opacity != 1.0f)
+	{
+		// Flag that this layer includes alpha/opacity changes
+		layer.hasAlpha = true;
+	}
+
+	// Get the style for this artwork
+	const AIPathStyle& style = resources.artInfo.GetStyle(artHandle);
+
+	// Does this artwork use a pattern fill or a gradient?
+	if (style.fillPaint)
+	{
+		switch (style.fill.color.kind)
+		{
+		case kPattern:
+		{
+			// Add the pattern
+			mainCanvas->documentResources->patterns.Add(style.fill.color.c.p.pattern, false);
+
+			// Flag that this layer includes patterns
+			layer.hasPatterns = true;
+			break;
+		}
+		case kGradient:
+		{
+			// Flag that this layer includes gradients
+			layer.hasGradients = true;
+			break;
+		}
+		case kGrayColor:
+		case kFourColor:
+		case kCustomColor:
+		case kThreeColor:
+		case kNoneColor:
+		{
+			break;
+		}
+		}
+	}
+
+	// Does this artwork use a pattern stroke?
+	if (style.strokePaint)
+	{
+		switch (style.stroke.color.kind)
+		{
+		case kPattern:
+		{
+			// Add the pattern
+			mainCanvas->documentResources->patterns.Add(style.stroke.color.c.p.pattern, false);
+
+			// Flag that this layer includes patterns
+			layer.hasPatterns = true;
+			break;
+		}
+		case kGradient:
+		{
+			// Flag that this layer includes gradients
+			layer.hasGradients = true;
+			break;
+		}
+		case kGrayColor:
+		case kFourColor:
+		case kCustomColor:
+		case kThreeColor:
+		case kNoneColor:
+		{
+			break;
+		}
+		}
+	}
 }
 
 void TypescriptDocument::RenderSymbolFunctions()
@@ -479,34 +586,34 @@ void TypescriptDocument::RenderSymbolFunctions()
 				Pattern* pattern = mainCanvas->documentResources->patterns.Patterns()[i];
 
 				// Begin symbol function block
-				outFile << "function " << pattern->name << "(ctx: CanvasRenderingContext2D) {" << endl;
+				context->out << "function " << pattern->name << "(" << context->contextName << ": CanvasRenderingContext2D) {" << endl;
 				{
-					Indentation indentation(outFile);
+					Indentation indentation(context->out);
 
 					// Need a blank line?
 					//if (pattern->hasAlpha || pattern->hasGradients || pattern->hasPatterns)
 					//{
-					//	outFile << endl;
+					//	context->out << endl;
 					//}
 
 					// Does this draw function have alpha changes?
 					if (pattern->hasAlpha)
 					{
 						// Grab the alpha value (so we can use it to compute new globalAlpha values during this draw function)
-						outFile << "const alpha = ctx.globalAlpha;" << endl;
+						context->out << "const " << context->alphaName << " = " << context->contextName << ".globalAlpha;" << endl;
 					}
 
 					// Will we be encountering gradients?
 					if (pattern->hasGradients)
 					{
-						outFile << "var gradient: CanvasGradient;" << endl;
+						context->out << "var " << context->gradientName << ": CanvasGradient;" << endl;
 					}
 
 					// Will we be encountering patterns?
 					// TODO: Is this even possible?
 					if (pattern->hasPatterns)
 					{
-						outFile << "var pattern: CanvasPattern;" << endl;
+						context->out << "var " << context->patternName << ": CanvasPattern;" << endl;
 					}
 
 					// Get a handle to the pattern art
@@ -516,9 +623,9 @@ void TypescriptDocument::RenderSymbolFunctions()
 					// While we're here, get the size of this canvas
 					AIRealRect bounds;
 					sAIArt->GetArtBounds(patternArtHandle, &bounds);
-					if (debug)
+					if (context->debug)
 					{
-						outFile << "// Symbol art bounds = " <<
+						context->out << "// Symbol art bounds = " <<
 							"left:" << setiosflags(ios::fixed) << setprecision(1) << bounds.left <<
 							", top:" << bounds.top <<
 							", right:" << bounds.right <<
@@ -526,11 +633,12 @@ void TypescriptDocument::RenderSymbolFunctions()
 					}
 
 					// Create canvas and set size
-					Canvas* canvas = new Canvas("canvas", &resources);			// No need to add it to the collection, since it doesn't represent a canvas element
-					canvas->contextName = "ctx";
+					Canvas* canvas = resources.arena.Create<Canvas>("canvas", &resources);			// No need to add it to the collection, since it doesn't represent a canvas element
+					canvas->contextName = context->contextName;
 					canvas->width = bounds.right - bounds.left;
 					canvas->height = bounds.top - bounds.bottom;
 					canvas->currentState->isProcessingSymbol = true;
+					canvas->isDefinition = true;
 
 					// Get the first art element in the symbol
 					AIArtHandle childArtHandle = NULL;
@@ -541,13 +649,10 @@ void TypescriptDocument::RenderSymbolFunctions()
 
 					// Restore remaining state
 					canvas->SetContextDrawingState(1);
-
-					// Free the canvas
-					delete canvas;
 				}
 
 				// End function block
-				outFile << "}" << endl;
+				context->out << "}" << endl;
 			}
 		}
 	}
@@ -559,9 +664,9 @@ void TypescriptDocument::RenderPatternFunction()
 	if (mainCanvas->documentResources->patterns.HasPatterns())
 	{
 		// Begin pattern function block
-		outFile << "function drawPatterns() {" << endl;
+		context->out << "function drawPatterns() {" << endl;
 		{
-			Indentation indentation(outFile);
+			Indentation indentation(context->out);
 			 
 			// Loop through patterns
 			for (unsigned int i = 0; i < mainCanvas->documentResources->patterns.Patterns().size(); i++)
@@ -577,9 +682,9 @@ void TypescriptDocument::RenderPatternFunction()
 
 					// Get pattern name
 					sAIPattern->GetPatternName(pattern->patternHandle, patternName);
-					if (debug)
+					if (context->debug)
 					{
-						outFile << "//   Pattern name = " << patternName.as_Platform() << " (" << pattern->patternHandle << ")" << endl;
+						context->out << "//   Pattern name = " << patternName.as_Platform() << " (" << pattern->patternHandle << ")" << endl;
 					}
 
 					// Create canvas ID
@@ -588,7 +693,7 @@ void TypescriptDocument::RenderPatternFunction()
 
 					// Create context name
 					std::ostringstream contextName;
-					contextName << "ctx" << pattern->canvasIndex;
+					contextName << context->contextName << pattern->canvasIndex;
 
 					// Create canvas for this pattern
 					Canvas* canvas = canvases.Add(canvasID.str(), contextName.str(), &resources);
@@ -596,8 +701,8 @@ void TypescriptDocument::RenderPatternFunction()
 					canvas->currentState->isProcessingSymbol = false;
 
 					// Render context commands
-					outFile << "const " << canvas->id << " = document.getElementById(\"" << canvas->id << "\");" << endl;
-					outFile << "const " << canvas->contextName << " = " << canvas->id << ".getContext(\"2d\");" << endl;
+					context->out << "const " << canvas->id << " = document.getElementById(\"" << canvas->id << "\");" << endl;
+					context->out << "const " << canvas->contextName << " = " << canvas->id << ".getContext(\"2d\");" << endl;
 
 					// Get a handle to the pattern art
 					AIArtHandle patternArtHandle = nil;
@@ -606,9 +711,9 @@ void TypescriptDocument::RenderPatternFunction()
 					// While we're here, get the size of this canvas
 					AIRealRect bounds;
 					sAIArt->GetArtBounds(patternArtHandle, &bounds);
-					if (debug)
+					if (context->debug)
 					{
-						outFile << "// Symbol art bounds = " <<
+						context->out << "// Symbol art bounds = " <<
 							"left:" << setiosflags(ios::fixed) << setprecision(1) << bounds.left <<
 							", top:" << bounds.top <<
 							", right:" << bounds.right <<
@@ -633,6 +738,7 @@ void TypescriptDocument::RenderPatternFunction()
 
 					// This canvas shound be hidden, since it's only used for the pattern artwork
 					canvas->isHidden = true;
+					canvas->isDefinition = true;
 
 					// Get the first art element in the pattern
 					AIArtHandle childArtHandle = NULL;
@@ -648,13 +754,13 @@ void TypescriptDocument::RenderPatternFunction()
 		}
 
 		// End function block
-		outFile << "}" << endl;
+		context->out << "}" << endl;
 	}
 }
 
 void TypescriptDocument::DebugInfo()
 {
-	outFile << "<p>This document has been exported in debug mode.</p>" << endl;
+	context->out << "<p>This document has been exported in debug mode.</p>" << endl;
 
 	resources.images.DebugInfo();
 
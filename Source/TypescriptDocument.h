@@ -31,23 +31,20 @@
 #include "Layer.h"
 #include "DocumentResources.h"
 #include "FunctionCollection.h"
+#include "ArtTraversal.h"
 
 AIBoolean			ProgressProc(long current, long total);
 
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	
-	extern bool debug;
-
 	/// Represents a document
-	class TypescriptDocument
+	class TypescriptDocument : public ArtVisitor
 	{
 	private:
 
 		CanvasCollection	canvases;
 		FunctionCollection	functions;
+		Layer*				scanLayer;						// Layer that ScanLayerArtwork is capturing data for
 
 		void				SetDocumentBounds();
 		void				ParseFolderPath(const std::string& pathName);
@@ -55,6 +52,7 @@ namespace CanvasExport
 		void				ScanDocument();
 		void				ScanLayer(Layer& layer);
 		void				ScanLayerArtwork(AIArtHandle artHandle, unsigned int depth, Layer& layer);
+		void				ScanArtStyle(AIArtHandle artHandle);
 		void				ParseLayers();
 		void				ParseLayerName(const Layer& layer, std::string& name, std::string& options);
 		void				SetFunctionOptions(const std::vector<std::string>& options, Function& function);
@@ -64,9 +62,10 @@ namespace CanvasExport
 
 	public:
 
-		TypescriptDocument(const std::string& pathName);
+		TypescriptDocument(const std::string& pathName, ExportContext& context);
 		~TypescriptDocument();
 
+		ExportContext*		context;						// Where the document is written
 		DocumentResources	resources;						// Document resources
 
 		std::vector<Layer*>	layers;							// Layers
@@ -75,6 +74,9 @@ namespace CanvasExport
 		AIRealRect			artboardBounds;					// Main artboard bounds
 
 		void				Render();
+		bool				Enter(AIArtHandle artHandle, unsigned int& depth) override;
+		bool				GetChildren(AIArtHandle artHandle, unsigned int depth, unsigned int pass, AIArtHandle& firstChild, unsigned int& childDepth) override;
+		void				Leave(AIArtHandle artHandle, unsigned int depth) override;
 	
 	};
 
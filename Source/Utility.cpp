@@ -22,35 +22,22 @@
 
 #include "IllustratorSDK.h"
 #include "Utility.h"
-#include "IndentableStream.h"
-
-namespace CanvasExport
-{
-	// Globals
-	std::ofstream outFileStream;
-	IndentableStream indentableStream(outFileStream);
-	std::ostream& outFile = indentableStream;
-}
-
-bool CanvasExport::OpenFile(const std::string& filePath)
-{
-	// Open the files
-	outFileStream.open(filePath.c_str(), ios::out);
-
-	// Return result
-	return outFileStream.is_open();
-}
-
-void CanvasExport::CloseFile()
-{
-	// Close the file
-	outFileStream.close();
-}
-
-void CanvasExport::RenderTransform(const AIRealMatrix& matrix)
+#include "ArtTraversal.h"
+#include "Hash.h"
+#include <atomic>
+#ifdef MAC_ENV
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef WIN_ENV
+#include <direct.h>
+#include <windows.h>
+#endif
+
+void CanvasExport::RenderTransform(std::ostream& out, const AIRealMatrix& matrix)
 {
 	// Transform
-	outFile << setiosflags(ios::fixed) << setprecision(3) <<
+	out << setiosflags(ios::fixed) << setprecision(3) <<
 		matrix.a << ", " << matrix.b << ", " << matrix.c << ", " << matrix.d << ", " << 
 		setprecision(1) <<
 		matrix.tx << ", " << matrix.ty;
@@ -198,6 +185,124 @@ void CanvasExport::CleanParameter(std::string& s)
 	s.erase(destIndex);
 }
 
+// Escape a string for use inside JSON double quotes
+std::string CanvasExport::EscapeJSON(const std::string& s)
+{
+	std::string result;
+	result.reserve(s.length());
+	for (size_t i = 0; i < s.length(); i++)
+	{
+		unsigned char c = (unsigned char)s[i];
+		switch (c)
+		{
+		case '"':	result += "\\\""; break;
+		case '\\':	result += "\\\\"; break;
+		case '\n':	result += "\\n"; break;
+		case '\r':	result += "\\r"; break;
+		case '\t':	result += "\\t"; break;
+		default:
+		{
+			if (c < 0x20)
+			{
+				// Other control characters
+				std::ostringstream escaped;
+				escaped << "\\u" << std::hex << std::setfill('0') << std::setw(4) << (int)c;
+				result += escaped.str();
+			}
+			else
+			{
+				result += (char)c;
+			}
+			break;
+		}
+		}
+	}
+	return result;
+}
+
+// Append UTF-16 text to a string as escaped UTF-8, ready for a JavaScript string literal
+// A high surrogate at the end of the text is kept in pendingSurrogate (0 if none), so a pair that's split between glyph
+// runs is combined by the next call
+void CanvasExport::AppendEscapedText(std::string& result, const ATETextDOM::Unicode* text, size_t length, ATETextDOM::Unicode& pendingSurrogate)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		unsigned long c = text[i];
+
+		// Combine surrogate pairs (unpaired surrogates become the replacement character)
+		if (c < 0xDC00 || c > 0xDFFF)
+		{
+			FinishEscapedText(result, pendingSurrogate);
+		}
+		if (c >= 0xD800 && c <= 0xDBFF)
+		{
+			// Wait for the low surrogate (which may start the next text)
+			pendingSurrogate = (ATETextDOM::Unicode)c;
+			continue;
+		}
+		else if (c >= 0xDC00 && c <= 0xDFFF)
+		{
+			c = pendingSurrogate ? 0x10000 + (((unsigned long)pendingSurrogate - 0xD800) << 10) + (c - 0xDC00) : 0xFFFD;
+			pendingSurrogate = 0;
+		}
+
+		switch (c)
+		{
+		case '"':	result += "\\\""; break;
+		case '\\':	result += "\\\\"; break;
+		case '\n':	result += "\\n"; break;
+		case '\r':	result += "\\r"; break;
+		case '\t':	result += "\\t"; break;
+		case 0x2028:	result += "\\u2028"; break;		// Line separator isn't allowed in older script parsers
+		case 0x2029:	result += "\\u2029"; break;		// Paragraph separator
+		default:
+		{
+			if (c < 0x20)
+			{
+				// Other control characters
+				static const char hexDigits[] = "0123456789abcdef";
+				result += "\\u00";
+				result += hexDigits[c >> 4];
+				result += hexDigits[c & 0xF];
+			}
+			else if (c < 0x80)
+			{
+				result += (char)c;
+			}
+			else if (c < 0x800)
+			{
+				result += (char)(0xC0 | (c >> 6));
+				result += (char)(0x80 | (c & 0x3F));
+			}
+			else if (c < 0x10000)
+			{
+				result += (char)(0xE0 | (c >> 12));
+				result += (char)(0x80 | ((c >> 6) & 0x3F));
+				result += (char)(0x80 | (c & 0x3F));
+			}
+			else
+			{
+				result += (char)(0xF0 | (c >> 18));
+				result += (char)(0x80 | ((c >> 12) & 0x3F));
+				result += (char)(0x80 | ((c >> 6) & 0x3F));
+				result += (char)(0x80 | (c & 0x3F));
+			}
+			break;
+		}
+		}
+	}
+}
+
+// Append a high surrogate that was never followed by its low surrogate (as the replacement character)
+void CanvasExport::FinishEscapedText(std::string& result, ATETextDOM::Unicode& pendingSurrogate)
+{
+	if (pendingSurrogate)
+	{
+		result += "\xEF\xBF\xBD";		// U+FFFD in UTF-8
+		pendingSurrogate = 0;
+	}
+}
+
 // Turn a string into a valid HTML ID
 // HTML5 ID draft spec: http://dev.w3.org/html5/spec/elements.html#the-id-attribute
 // Note that most references recommend using A-Z, a-z, 0-9, and should begin with an alpha character
@@ -263,6 +368,66 @@ bool CanvasExport::FileExists(const std::string& fileName)
 	return filePath.Exists(true);
 }
 
+// Copies a file byte-for-byte, returns false if anything failed
+bool CanvasExport::CopyBinaryFile(const std::string& sourcePath, const std::string& destinationPath)
+{
+	// Open both files
+	std::ifstream source(sourcePath.c_str(), ios::in | ios::binary);
+	std::ofstream destination(destinationPath.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!source.is_open() || !destination.is_open())
+	{
+		return false;
+	}
+
+	// Copy everything
+	destination << source.rdbuf();
+
+	return !destination.fail();
+}
+
+// Get the size of a file, returns false if it can't be read
+bool CanvasExport::GetFileSize(const std::string& path, uint64_t& size)
+{
+	std::ifstream file(path.c_str(), ios::in | ios::binary | ios::ate);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	size = (uint64_t)file.tellg();
+	return true;
+}
+
+// Returns the modification time in file information (in the platform's units, only good for comparisons)
+uint64_t CanvasExport::GetModificationTime(const SPPlatformFileInfo& fileInfo)
+{
+#ifdef MAC_ENV
+	return fileInfo.modificationDate;
+#endif
+#ifdef WIN_ENV
+	return ((uint64_t)fileInfo.highModificationTime << 32) | fileInfo.lowModificationTime;
+#endif
+}
+
+// Creates a folder (if it doesn't exist yet), returns false if it isn't there afterwards
+bool CanvasExport::CreateFolder(const std::string& path)
+{
+	// Already there?
+	if (FileExists(path))
+	{
+		return true;
+	}
+
+	// Create it
+#ifdef MAC_ENV
+	mkdir(path.c_str(), 0755);
+#endif
+#ifdef WIN_ENV
+	_mkdir(path.c_str());
+#endif
+
+	return FileExists(path);
+}
+
 // Update bounds to include newBounds
 // TODO: Is there an Illustrator function to do this?
 void CanvasExport::UpdateBounds(const AIRealRect& newBounds, AIRealRect& bounds)
@@ -286,30 +451,59 @@ void CanvasExport::UpdateBounds(const AIRealRect& newBounds, AIRealRect& bounds)
 	}
 }
 
-// Find a unique filename
-// Path should have a trailing backslash ("c:\output\"), and extension should include a period (".png")
-std::string CanvasExport::GetUniqueFileName(const std::string& path, const std::string& fileName, const std::string& extension)
+// Name of a temporary file that an asset is written to before it's named after its content
+// Every call gets a new name, so exports to the same folder (from this or another process) don't overwrite each other's files
+std::string CanvasExport::GetTempAssetName(const std::string& extension)
 {
-	// Find a unique filename
-	std::ostringstream uniqueFileName;
+	// Number the files written by this process
+	static std::atomic<unsigned int> tempCount(0);
+
+	// Tell processes apart
+#ifdef MAC_ENV
+	unsigned long processID = (unsigned long)getpid();
+#endif
+#ifdef WIN_ENV
+	unsigned long processID = (unsigned long)GetCurrentProcessId();
+#endif
+
+	std::ostringstream name;
+	name << "~ai2canvas-temp-" << processID << "-" << ++tempCount << extension;
+	return name.str();
+}
 
-	// Find a unique file name
-	int unique = 0;
-	do
-	{
-		// Increment to make unique name
-		unique++;
+// Names a freshly written file after its content ("<baseName>-<hash><extension>"), and returns the new file name
+// Unchanged artwork keeps its file name between exports (so caches don't need to fetch it again), and identical
+// files share a single name
+std::string CanvasExport::NameFileByContent(const std::string& folderPath, const std::string& tempPath, const std::string& baseName, const std::string& extension)
+{
+	// Hash the content
+	Hash hash;
+	hash.AddFile(tempPath);
+
+	// Construct the file name (48 bits of the hash are plenty to keep assets apart)
+	std::string fileName = baseName + "-" + hash.ToString().substr(0, 12) + extension;
+	std::string fullPath = folderPath + fileName;
 
-		// Generate a unique file name
-		uniqueFileName.str("");
-		uniqueFileName << fileName << unique << extension;
-	} while (FileExists((path + uniqueFileName.str())));
+	// Does a file with this content already exist?
+	if (FileExists(fullPath))
+	{
+		// Keep it, and discard the new copy
+		remove(tempPath.c_str());
+	}
+	else
+	{
+		// Move the new file into place
+		if (rename(tempPath.c_str(), fullPath.c_str()) != 0)
+		{
+			// Another export put the same content there first (so ours isn't needed)
+			remove(tempPath.c_str());
+		}
+	}
 
-	// Return unique file name
-	return uniqueFileName.str();
+	return fileName;
 }
 
-void CanvasExport::WriteArtTree()
+void CanvasExport::WriteArtTree(std::ostream& out)
 {
 	AILayerHandle layerHandle = NULL;
 	ai::int32 layerCount = 0;
@@ -328,42 +522,66 @@ void CanvasExport::WriteArtTree()
 		sAIArt->GetFirstArtOfLayer(layerHandle, &artHandle);
 
 		// Dig in
-		WriteArtTree(artHandle, 0);
+		WriteArtTree(out, artHandle, 0);
 	}
 }
 
-void CanvasExport::WriteArtTree(AIArtHandle artHandle, int depth)
+namespace CanvasExport
 {
-	// Simple way to describe art types for debugging purposes
-	static const char *artTypes[] = 
+	// Writes art type and name for each art object, and descends into every child
+	class ArtTreeWriter : public ArtVisitor
 	{
-		"kUnknownArt", "kGroupArt", "kPathArt", "kCompoundPathArt", "kTextArtUnsupported", "kTextPathArtUnsupported", "kTextRunArtUnsupported", "kPlacedArt", "kMysteryPathArt", "kRasterArt", "kPluginArt", "kMeshArt", "kTextFrameArt", "kSymbolArt", "kForeignArt", "kLegacyTextArt"
-	};
+	public:
 
-	// Loop through art and its siblings
-	do
-	{
-		// Art type
-		short type = 0;
-		sAIArt->GetArtType(artHandle, &type);
-		outFile << "//" << std::string(artTypes[type]) << " (" << type << ")" << endl;
-
-		// Get art name
-		ai::UnicodeString artName;
-		AIBoolean isDefaultName = false;
-		sAIArt->GetArtName(artHandle, artName, &isDefaultName);
-		outFile << ": " << artName.as_Platform();
-
-		// Any children?
-		AIArtHandle childArtHandle;
-		sAIArt->GetArtFirstChild(artHandle, &childArtHandle);
-		if (childArtHandle != NULL)
+		std::ostream* out;			// Where the tree is written
+
+		bool Enter(AIArtHandle artHandle, unsigned int& depth) override
 		{
-			WriteArtTree(childArtHandle, depth + 1);
+			// Simple way to describe art types for debugging purposes
+			static const char *artTypes[] = 
+			{
+				"kUnknownArt", "kGroupArt", "kPathArt", "kCompoundPathArt", "kTextArtUnsupported", "kTextPathArtUnsupported", "kTextRunArtUnsupported", "kPlacedArt", "kMysteryPathArt", "kRasterArt", "kPluginArt", "kMeshArt", "kTextFrameArt", "kSymbolArt", "kForeignArt", "kLegacyTextArt"
+			};
+
+			(void)depth;
+
+			// Art type
+			short type = 0;
+			sAIArt->GetArtType(artHandle, &type);
+			*out << "//" << std::string(artTypes[type]) << " (" << type << ")" << endl;
+
+			// Get art name
+			ai::UnicodeString artName;
+			AIBoolean isDefaultName = false;
+			sAIArt->GetArtName(artHandle, artName, &isDefaultName);
+			*out << ": " << artName.as_Platform();
+
+			return true;
 		}
 
-		// Find the next sibling
-		sAIArt->GetArtSibling(artHandle, &artHandle);
-	}
-	while (artHandle != nil);
+		bool GetChildren(AIArtHandle artHandle, unsigned int depth, unsigned int pass, AIArtHandle& firstChild, unsigned int& childDepth) override
+		{
+			// Any children?
+			sAIArt->GetArtFirstChild(artHandle, &firstChild);
+			childDepth = depth + 1;
+			return (pass == 0);
+		}
+
+		void Leave(AIArtHandle artHandle, unsigned int depth) override
+		{
+			(void)artHandle;
+			(void)depth;
+		}
+	};
+}
+
+void CanvasExport::WriteArtTree(std::ostream& out, AIArtHandle artHandle, int depth)
+{
+	// Loop through art, its siblings and their children
+	ArtInfoCache artInfo;
+	ArtTraversal traversal;
+	traversal.artInfo = &artInfo;
+	ArtTreeWriter writer;
+	writer.out = &out;
+	traversal.Run(writer, artHandle, (unsigned int)depth, ArtTraversal::kDocumentOrder);
 }
\ No newline at end of file
@@ -30,26 +30,36 @@
 #include <iomanip>
 #include <string>
 
+// Separator between folder and file names
+#ifdef MAC_ENV
+#define PATH_SEPARATOR "/"
+#endif
+#ifdef WIN_ENV
+#define PATH_SEPARATOR "\\"
+#endif
+
 namespace CanvasExport
 {
-	// Globals
-	extern std::ostream& outFile;
-	extern bool debug;
-
-	bool OpenFile(const std::string& filePath);
-	void CloseFile();
-	void RenderTransform(const AIRealMatrix& matrix);
+	void RenderTransform(std::ostream& out, const AIRealMatrix& matrix);
 	void Replace(std::string& s, char find, char replace);
 	void CleanString(std::string& s, AIBoolean camelCase);
 	void CleanFunction(std::string& s);
 	void CleanParameter(std::string& s);
 	void ToLower(std::string& s);
+	std::string EscapeJSON(const std::string& s);
+	void AppendEscapedText(std::string& result, const ATETextDOM::Unicode* text, size_t length, ATETextDOM::Unicode& pendingSurrogate);
+	void FinishEscapedText(std::string& result, ATETextDOM::Unicode& pendingSurrogate);
 	void MakeValidID(std::string& s);
 	vector<string> Tokenize(const std::string& str, const std::string& delimiters);
 	bool FileExists(const std::string& fileName);
+	bool CopyBinaryFile(const std::string& sourcePath, const std::string& destinationPath);
+	bool GetFileSize(const std::string& path, uint64_t& size);
+	uint64_t GetModificationTime(const SPPlatformFileInfo& fileInfo);
+	bool CreateFolder(const std::string& path);
 	void UpdateBounds(const AIRealRect& newBounds, AIRealRect& bounds);
-	std::string GetUniqueFileName(const std::string& path, const std::string& fileName, const std::string& extension);
-	void WriteArtTree();
-	void WriteArtTree(AIArtHandle artHandle, int depth);
+	std::string GetTempAssetName(const std::string& extension);
+	std::string NameFileByContent(const std::string& folderPath, const std::string& tempPath, const std::string& baseName, const std::string& extension);
+	void WriteArtTree(std::ostream& out);
+	void WriteArtTree(std::ostream& out, AIArtHandle artHandle, int depth);
 }
 #endif
\ No newline at end of file